@@ -20,7 +20,7 @@ pyuv__deallocate_handle_data(uv_handle_t *handle)
 static void
 pyuv__pipe_connect_abstract_cb(uv_timer_t *timer)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(timer->loop);
     PyObject *result, *error;
     abstract_connect_req *req;
 
@@ -43,7 +43,7 @@ pyuv__pipe_connect_abstract_cb(uv_timer_t *timer)
 
     uv_close((uv_handle_t *) &req->timer, pyuv__deallocate_handle_data);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
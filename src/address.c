@@ -0,0 +1,233 @@
+
+static socklen_t
+pyuv__sockaddr_len(const struct sockaddr *addr)
+{
+    switch (addr->sa_family) {
+        case AF_INET:
+            return sizeof(struct sockaddr_in);
+        case AF_INET6:
+            return sizeof(struct sockaddr_in6);
+        default:
+            return 0;
+    }
+}
+
+
+static Bool
+pyuv__sockaddr_equal(const struct sockaddr *a, const struct sockaddr *b)
+{
+    const struct sockaddr_in *a4, *b4;
+    const struct sockaddr_in6 *a6, *b6;
+
+    if (a->sa_family != b->sa_family) {
+        return False;
+    }
+
+    switch (a->sa_family) {
+        case AF_INET:
+            a4 = (const struct sockaddr_in *)a;
+            b4 = (const struct sockaddr_in *)b;
+            return a4->sin_port == b4->sin_port && a4->sin_addr.s_addr == b4->sin_addr.s_addr;
+        case AF_INET6:
+            a6 = (const struct sockaddr_in6 *)a;
+            b6 = (const struct sockaddr_in6 *)b;
+            return a6->sin6_port == b6->sin6_port &&
+                   a6->sin6_flowinfo == b6->sin6_flowinfo &&
+                   a6->sin6_scope_id == b6->sin6_scope_id &&
+                   memcmp(&a6->sin6_addr, &b6->sin6_addr, sizeof(a6->sin6_addr)) == 0;
+        default:
+            return False;
+    }
+}
+
+
+/* Create an Address of the given type from a sockaddr. Unknown address families give None,
+ * like makesockaddr */
+static PyObject *
+pyuv__address_from_sockaddr(PyTypeObject *type, const struct sockaddr *addr)
+{
+    PyObject *self, *tuple, *item;
+    socklen_t len;
+    Py_ssize_t i, n;
+
+    len = pyuv__sockaddr_len(addr);
+    if (len == 0) {
+        Py_RETURN_NONE;
+    }
+
+    tuple = makesockaddr((struct sockaddr *)addr);
+    if (tuple == NULL) {
+        return NULL;
+    }
+
+    n = PyTuple_GET_SIZE(tuple);
+    self = type->tp_alloc(type, n);
+    if (self == NULL) {
+        Py_DECREF(tuple);
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        item = PyTuple_GET_ITEM(tuple, i);
+        Py_INCREF(item);
+        PyTuple_SET_ITEM(self, i, item);
+    }
+    Py_DECREF(tuple);
+
+    memset(PYUV_ADDRESS_SOCKADDR(self), 0, sizeof(struct sockaddr_storage));
+    memcpy(PYUV_ADDRESS_SOCKADDR(self), addr, len);
+
+    return self;
+}
+
+
+static PyObject *
+pyuv__address_new(const struct sockaddr *addr)
+{
+    return pyuv__address_from_sockaddr(&AddressType, addr);
+}
+
+
+static PyObject *
+Address_tp_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *addr;
+    struct sockaddr_storage ss;
+
+    if (kwargs != NULL && PyDict_Size(kwargs) != 0) {
+        PyErr_SetString(PyExc_TypeError, "Address() takes no keyword arguments");
+        return NULL;
+    }
+
+    /* Address((ip, port)) is accepted as well, it's what copy and pickle use */
+    addr = args;
+    if (PyTuple_GET_SIZE(args) == 1 && PyTuple_Check(PyTuple_GET_ITEM(args, 0))) {
+        addr = PyTuple_GET_ITEM(args, 0);
+    }
+
+    if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
+        return NULL;
+    }
+
+    return pyuv__address_from_sockaddr(type, (struct sockaddr *)&ss);
+}
+
+
+static PyObject *
+Address_tp_repr(PyObject *self)
+{
+    PyObject *r, *result;
+
+    r = PyTuple_Type.tp_repr(self);
+    if (r == NULL) {
+        return NULL;
+    }
+#ifdef PYUV_PYTHON3
+    result = PyUnicode_FromFormat("Address%U", r);
+#else
+    result = PyString_FromFormat("Address%s", PyString_AS_STRING(r));
+#endif
+    Py_DECREF(r);
+    return result;
+}
+
+
+static PyObject *
+Address_func_reduce(PyObject *self)
+{
+    PyObject *tuple, *result;
+
+    tuple = PyTuple_GetSlice(self, 0, PyTuple_GET_SIZE(self));
+    if (tuple == NULL) {
+        return NULL;
+    }
+    result = Py_BuildValue("(O(N))", (PyObject *)Py_TYPE(self), tuple);
+    return result;
+}
+
+
+static PyObject *
+Address_family_get(PyObject *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyInt_FromLong((long)PYUV_ADDRESS_SOCKADDR(self)->ss_family);
+}
+
+
+static PyObject *
+Address_item_get(PyObject *self, void *closure)
+{
+    Py_ssize_t i;
+    PyObject *item;
+
+    i = (Py_ssize_t)closure;
+    if (i >= PyTuple_GET_SIZE(self)) {
+        /* flowinfo and scope_id of IPv4 addresses */
+        return PyInt_FromLong(0);
+    }
+
+    item = PyTuple_GET_ITEM(self, i);
+    Py_INCREF(item);
+    return item;
+}
+
+
+static PyMethodDef
+Address_tp_methods[] = {
+    { "__reduce__", (PyCFunction)Address_func_reduce, METH_NOARGS, "Support for pickle." },
+    { NULL }
+};
+
+
+static PyGetSetDef Address_tp_getsets[] = {
+    {"family", (getter)Address_family_get, NULL, "Address family (socket.AF_INET or socket.AF_INET6).", NULL},
+    {"host", (getter)Address_item_get, NULL, "IP address.", (void *)0},
+    {"port", (getter)Address_item_get, NULL, "Port number.", (void *)1},
+    {"flowinfo", (getter)Address_item_get, NULL, "Flow info (IPv6 only).", (void *)2},
+    {"scope_id", (getter)Address_item_get, NULL, "Scope ID (IPv6 only).", (void *)3},
+    {NULL}
+};
+
+
+/* The parsed sockaddr is stored right after the tuple items */
+static PyTypeObject AddressType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyuv._cpyuv.Address",                                         /*tp_name*/
+    sizeof(PyTupleObject) - sizeof(PyObject *) + sizeof(struct sockaddr_storage), /*tp_basicsize*/
+    sizeof(PyObject *),                                            /*tp_itemsize*/
+    0,                                                             /*tp_dealloc*/
+    0,                                                             /*tp_print*/
+    0,                                                             /*tp_getattr*/
+    0,                                                             /*tp_setattr*/
+    0,                                                             /*tp_compare*/
+    (reprfunc)Address_tp_repr,                                     /*tp_repr*/
+    0,                                                             /*tp_as_number*/
+    0,                                                             /*tp_as_sequence*/
+    0,                                                             /*tp_as_mapping*/
+    0,                                                             /*tp_hash */
+    0,                                                             /*tp_call*/
+    0,                                                             /*tp_str*/
+    0,                                                             /*tp_getattro*/
+    0,                                                             /*tp_setattro*/
+    0,                                                             /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,                                            /*tp_flags*/
+    0,                                                             /*tp_doc*/
+    0,                                                             /*tp_traverse*/
+    0,                                                             /*tp_clear*/
+    0,                                                             /*tp_richcompare*/
+    0,                                                             /*tp_weaklistoffset*/
+    0,                                                             /*tp_iter*/
+    0,                                                             /*tp_iternext*/
+    Address_tp_methods,                                            /*tp_methods*/
+    0,                                                             /*tp_members*/
+    Address_tp_getsets,                                            /*tp_getsets*/
+    0,                                                             /*tp_base*/
+    0,                                                             /*tp_dict*/
+    0,                                                             /*tp_descr_get*/
+    0,                                                             /*tp_descr_set*/
+    0,                                                             /*tp_dictoffset*/
+    0,                                                             /*tp_init*/
+    0,                                                             /*tp_alloc*/
+    Address_tp_new,                                                /*tp_new*/
+};
+
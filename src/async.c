@@ -2,7 +2,7 @@
 static void
 pyuv__async_cb(uv_async_t *handle)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Async *self;
     PyObject *result;
 
@@ -22,7 +22,7 @@ pyuv__async_cb(uv_async_t *handle)
         Py_DECREF(self);
     }
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
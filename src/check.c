@@ -2,7 +2,7 @@
 static void
 pyuv__check_cb(uv_check_t *handle)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Check *self;
     PyObject *result;
 
@@ -19,7 +19,7 @@ pyuv__check_cb(uv_check_t *handle)
     Py_XDECREF(result);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -109,7 +109,8 @@ pyuv_dup_strobj(PyObject *obj)
 }
 
 
-/* parse a Python tuple containing host, port, flowinfo, scope_id into a sockaddr struct */
+/* parse a Python tuple containing host, port, flowinfo, scope_id into a sockaddr struct,
+ * Address objects are already parsed and just copied */
 static int
 pyuv_parse_addr_tuple(PyObject *addr, struct sockaddr_storage *ss)
 {
@@ -121,10 +122,15 @@ pyuv_parse_addr_tuple(PyObject *addr, struct sockaddr_storage *ss)
     struct sockaddr_in *sa4;
     struct sockaddr_in6 *sa6;
 
+    if (Py_TYPE(addr) == &AddressType) {
+        memcpy(ss, PYUV_ADDRESS_SOCKADDR(addr), sizeof(struct sockaddr_storage));
+        return 0;
+    }
+
     flowinfo = scope_id = 0;
 
     if (!PyTuple_Check(addr)) {
-        PyErr_Format(PyExc_TypeError, "address must be tuple, not %.500s", Py_TYPE(addr)->tp_name);
+        PyErr_Format(PyExc_TypeError, "address must be tuple or Address, not %.500s", Py_TYPE(addr)->tp_name);
         return -1;
     }
 
@@ -283,20 +289,338 @@ handle_uncaught_exception(Loop *loop)
 }
 
 
+/* Acquire the GIL on entry to a libuv callback. When the loop runs with hold_gil
+ * enabled the GIL is only released around the blocking poll, so the first callback
+ * after it takes the GIL back and keeps it for the rest of the iteration. */
+static INLINE int
+pyuv__gil_ensure(uv_loop_t *uv_loop)
+{
+    Loop *loop;
+    PyThreadState *tstate;
+
+    loop = uv_loop->data;
+    if (loop && loop->gil.active) {
+        tstate = loop->gil.tstate;
+        if (tstate == NULL) {
+            return PYUV_GIL_LOOP_OWNED;
+        }
+        if (tstate == PyGILState_GetThisThreadState()) {
+            loop->gil.tstate = NULL;
+            PyEval_RestoreThread(tstate);
+            return PYUV_GIL_LOOP_OWNED;
+        }
+    }
+
+    return (int)PyGILState_Ensure();
+}
+
+
+static INLINE void
+pyuv__gil_release(int gstate)
+{
+    if (gstate != PYUV_GIL_LOOP_OWNED) {
+        PyGILState_Release((PyGILState_STATE)gstate);
+    }
+}
+
+
+/* Get a read buffer from the loop pool, allocating a new one if the pool is empty.
+ * This may run without the GIL held, so the system allocator is used. */
+static char *
+pyuv__buffer_get(Loop *loop, size_t *len)
+{
+    pyuv_buffer_t *b;
+
+    b = loop->buffer.free_list;
+    if (b != NULL) {
+        loop->buffer.free_list = b->next;
+        loop->buffer.free_count--;
+        loop->buffer.hits++;
+    } else {
+        b = malloc(sizeof(pyuv_buffer_t) + loop->buffer.size);
+        if (b == NULL) {
+            *len = 0;
+            return NULL;
+        }
+        b->size = loop->buffer.size;
+        loop->buffer.memory += b->size;
+        loop->buffer.misses++;
+    }
+
+    b->next = NULL;
+    loop->buffer.in_use++;
+    *len = b->size;
+    return PYUV_BUFFER_DATA(b);
+}
+
+
+/* Return a read buffer to the loop pool. Buffers are freed if the pool is full or if
+ * they were allocated before the buffer size was changed. */
 static void
-pyuv__alloc_cb(uv_handle_t* handle, size_t suggested_size, uv_buf_t *buf)
+pyuv__buffer_put(Loop *loop, char *base)
+{
+    pyuv_buffer_t *b;
+
+    if (base == NULL) {
+        return;
+    }
+
+    b = PYUV_BUFFER_HEADER(base);
+    loop->buffer.in_use--;
+
+    if (b->size == loop->buffer.size && loop->buffer.free_count < loop->buffer.depth) {
+        b->next = loop->buffer.free_list;
+        loop->buffer.free_list = b;
+        loop->buffer.free_count++;
+    } else {
+        loop->buffer.memory -= b->size;
+        free(b);
+    }
+}
+
+
+/* Take a read buffer out of the pool accounting, it's now owned by the caller and
+ * must be released with pyuv__buffer_free. */
+static void
+pyuv__buffer_detach(Loop *loop, char *base)
+{
+    pyuv_buffer_t *b;
+
+    b = PYUV_BUFFER_HEADER(base);
+    loop->buffer.in_use--;
+    loop->buffer.memory -= b->size;
+}
+
+
+static void
+pyuv__buffer_free(char *base)
+{
+    free(PYUV_BUFFER_HEADER(base));
+}
+
+
+/* Release pooled buffers until at most 'depth' of them are kept */
+static void
+pyuv__buffer_trim(Loop *loop, unsigned int depth)
+{
+    pyuv_buffer_t *b;
+
+    while (loop->buffer.free_count > depth) {
+        b = loop->buffer.free_list;
+        loop->buffer.free_list = b->next;
+        loop->buffer.free_count--;
+        loop->buffer.memory -= b->size;
+        free(b);
+    }
+}
+
+
+/* Release cached request contexts until at most 'depth' of them are kept */
+static void
+pyuv__req_trim(pyuv_req_cache_t *cache, unsigned int depth)
+{
+    void *ctx;
+
+    while (cache->free_count > depth) {
+        ctx = cache->free_list;
+        cache->free_list = *(void **)ctx;
+        cache->free_count--;
+        PyMem_Free(ctx);
+    }
+    if (cache->min_free > cache->free_count) {
+        cache->min_free = cache->free_count;
+    }
+}
+
+
+static void
+pyuv__req_trim_all(Loop *loop, unsigned int depth)
+{
+    pyuv__req_trim(&loop->reqs.write, depth);
+    pyuv__req_trim(&loop->reqs.shutdown, depth);
+    pyuv__req_trim(&loop->reqs.udp_send, depth);
+    pyuv__req_trim(&loop->reqs.proxy_write, depth);
+}
+
+
+/* Contexts which were not needed during the last idle period (the lowest number of
+ * free contexts seen since the previous check) are released. */
+static void
+pyuv__req_shrink(Loop *loop, pyuv_req_cache_t *cache)
+{
+    unsigned int before;
+
+    before = cache->free_count;
+    pyuv__req_trim(cache, cache->free_count - cache->min_free);
+    loop->reqs.trimmed += before - cache->free_count;
+    cache->min_free = cache->free_count;
+}
+
+
+/* Get a request context from the loop cache, allocating a new one if the cache is empty.
+ * Must be called with the GIL held. */
+static void *
+pyuv__req_get(Loop *loop, pyuv_req_cache_t *cache, size_t size)
+{
+    void *ctx;
+
+    ctx = cache->free_list;
+    if (ctx != NULL) {
+        cache->free_list = *(void **)ctx;
+        cache->free_count--;
+        if (cache->free_count < cache->min_free) {
+            cache->min_free = cache->free_count;
+        }
+        loop->reqs.hits++;
+    } else {
+        ctx = PyMem_Malloc(size);
+        if (ctx == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        loop->reqs.misses++;
+    }
+
+    loop->reqs.in_use++;
+    return ctx;
+}
+
+
+/* Runs every PYUV_REQ_CACHE_IDLE_MS while there are cached contexts, so an idle loop
+ * releases them too. The timer doesn't keep the loop alive. */
+static void
+pyuv__req_trim_cb(uv_timer_t *handle)
 {
+    int gstate = pyuv__gil_ensure(handle->loop);
     Loop *loop;
+
     loop = handle->loop->data;
     ASSERT(loop);
 
-    if (loop->buffer.in_use) {
-        buf->base = NULL;
-        buf->len = 0;
+    pyuv__req_shrink(loop, &loop->reqs.write);
+    pyuv__req_shrink(loop, &loop->reqs.shutdown);
+    pyuv__req_shrink(loop, &loop->reqs.udp_send);
+    pyuv__req_shrink(loop, &loop->reqs.proxy_write);
+
+    if (loop->reqs.write.free_count == 0 && loop->reqs.shutdown.free_count == 0 &&
+        loop->reqs.udp_send.free_count == 0 && loop->reqs.proxy_write.free_count == 0) {
+        uv_timer_stop(handle);
+    }
+
+    pyuv__gil_release(gstate);
+}
+
+
+/* Return a request context to the loop cache */
+static void
+pyuv__req_put(Loop *loop, pyuv_req_cache_t *cache, void *ctx)
+{
+    loop->reqs.in_use--;
+
+    if (cache->free_count < loop->reqs.depth) {
+        *(void **)ctx = cache->free_list;
+        cache->free_list = ctx;
+        cache->free_count++;
     } else {
-        buf->base = loop->buffer.slab;
-        buf->len = sizeof(loop->buffer.slab);
-        loop->buffer.in_use = True;
+        PyMem_Free(ctx);
+        return;
+    }
+
+    if (!loop->reqs.timer_initialized) {
+        uv_timer_init(loop->uv_loop, &loop->reqs.trim_timer);
+        loop->reqs.trim_timer.data = NULL;
+        loop->reqs.timer_initialized = True;
+    }
+    if (!uv_is_active((uv_handle_t *)&loop->reqs.trim_timer)) {
+        uv_timer_start(&loop->reqs.trim_timer, pyuv__req_trim_cb, PYUV_REQ_CACHE_IDLE_MS, PYUV_REQ_CACHE_IDLE_MS);
+        uv_unref((uv_handle_t *)&loop->reqs.trim_timer);
     }
 }
 
+
+/* Set the watermarks from Python arguments, the high watermark being 0 disables them */
+static int
+pyuv__watermarks_set(pyuv_watermarks_t *wm, Py_ssize_t high, Py_ssize_t low, PyObject *on_pause, PyObject *on_resume)
+{
+    PyObject *tmp;
+
+    if (high < 0 || low < 0 || low > high) {
+        PyErr_SetString(PyExc_ValueError, "watermarks must satisfy 0 <= low <= high");
+        return -1;
+    }
+
+    if ((on_pause != Py_None && !PyCallable_Check(on_pause)) || (on_resume != Py_None && !PyCallable_Check(on_resume))) {
+        PyErr_SetString(PyExc_TypeError, "a callable or None is required");
+        return -1;
+    }
+
+    tmp = wm->on_pause;
+    Py_INCREF(on_pause);
+    wm->on_pause = on_pause;
+    Py_XDECREF(tmp);
+
+    tmp = wm->on_resume;
+    Py_INCREF(on_resume);
+    wm->on_resume = on_resume;
+    Py_XDECREF(tmp);
+
+    wm->high = (size_t)high;
+    wm->low = (size_t)low;
+    if (high == 0) {
+        wm->paused = False;
+    }
+
+    return 0;
+}
+
+
+/* Check the queue size against the watermarks, calling the pause callback when it goes
+ * above the high watermark and the resume callback when it drains down to the low one */
+static void
+pyuv__watermarks_update(pyuv_watermarks_t *wm, PyObject *handle, Loop *loop, size_t size)
+{
+    PyObject *callback, *result;
+
+    if (wm->high == 0) {
+        return;
+    }
+
+    if (!wm->paused && size > wm->high) {
+        wm->paused = True;
+        callback = wm->on_pause;
+    } else if (wm->paused && size <= wm->low) {
+        wm->paused = False;
+        callback = wm->on_resume;
+    } else {
+        return;
+    }
+
+    if (callback == NULL || callback == Py_None) {
+        return;
+    }
+
+    /* The callback could change the watermarks */
+    Py_INCREF(callback);
+    result = PyObject_CallFunctionObjArgs(callback, handle, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(loop);
+    }
+    Py_XDECREF(result);
+    Py_DECREF(callback);
+}
+
+
+static void
+pyuv__alloc_cb(uv_handle_t* handle, size_t suggested_size, uv_buf_t *buf)
+{
+    Loop *loop;
+    size_t len;
+    loop = handle->loop->data;
+    ASSERT(loop);
+
+    UNUSED_ARG(suggested_size);
+
+    buf->base = pyuv__buffer_get(loop, &len);
+    buf->len = len;
+}
+
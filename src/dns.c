@@ -46,7 +46,7 @@ pyuv__getaddrinfo_process_result(int status, struct addrinfo* res, PyObject** dn
 static void
 pyuv__getaddrinfo_cb(uv_getaddrinfo_t* req, int status, struct addrinfo* res)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->loop);
     Loop *loop;
     GAIRequest *gai_req;
     PyObject *errorno, *dns_result, *result;
@@ -79,7 +79,7 @@ pyuv__getaddrinfo_cb(uv_getaddrinfo_t* req, int status, struct addrinfo* res)
     UV_REQUEST(gai_req) = NULL;
     Py_DECREF(gai_req);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -102,7 +102,7 @@ pyuv__getnameinfo_process_result(int status, const char *hostname, const char*se
 static void
 pyuv__getnameinfo_cb(uv_getnameinfo_t* req, int status, const char *hostname, const char *service)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->loop);
     Loop *loop;
     GNIRequest *gni_req;
     PyObject *errorno, *gni_result, *result;
@@ -132,7 +132,7 @@ pyuv__getnameinfo_cb(uv_getnameinfo_t* req, int status, const char *hostname, co
     UV_REQUEST(gni_req) = NULL;
     Py_DECREF(gni_req);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -1,3 +1,147 @@
+#ifndef PYUV_WINDOWS
+#include <dirent.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
+/* libuv gained copyfile in 1.14, the bundled version doesn't have it yet */
+#ifndef UV_FS_COPYFILE_EXCL
+#define UV_FS_COPYFILE_EXCL             0x0001
+#endif
+#ifndef UV_FS_COPYFILE_FICLONE_FORCE
+#define UV_FS_COPYFILE_FICLONE_FORCE    0x0004
+#endif
+#define PYUV_FS_COPYFILE                UV_FS_CUSTOM
+
+/* Amount of data transferred by each threadpool job of a sendfile with progress reporting */
+#define PYUV_SENDFILE_CHUNK             (64 * 1024 * 1024)
+
+typedef struct {
+    char *name;
+    uv_dirent_type_t type;
+} fs_scandir_entry;
+
+typedef struct {
+    uv_work_t req;
+    FSRequest *fs_req;
+    char *path;
+#ifdef PYUV_WINDOWS
+    uv_fs_t scandir_req;
+    Bool opened;
+#else
+    DIR *dir;
+#endif
+    fs_scandir_entry *entries;
+    size_t nentries;
+    size_t chunk_size;
+    int error;
+    Bool eof;
+} fs_scandir_ctx;
+
+typedef struct {
+    uv_fs_type type;
+    const char *path;
+    const char *new_path;
+    int mode;
+    ssize_t result;
+    uv_stat_t statbuf;
+} fs_batch_op;
+
+typedef struct fs_batch_ctx_s fs_batch_ctx;
+
+typedef struct {
+    uv_work_t req;
+    fs_batch_ctx *ctx;
+    Py_ssize_t start;
+    Py_ssize_t end;
+} fs_batch_chunk;
+
+struct fs_batch_ctx_s {
+    FSRequest *fs_req;
+    PyObject *ops_obj;
+    PyObject *progress;
+    fs_batch_op *ops;
+    fs_batch_chunk *chunks;
+    Py_ssize_t count;
+    Py_ssize_t completed;
+    Py_ssize_t nchunks;
+    Py_ssize_t chunks_done;
+};
+
+
+
+typedef struct {
+    char *name;
+    uv_dirent_type_t type;
+    Bool has_stat;
+    uv_stat_t statbuf;
+} fs_walk_entry;
+
+typedef struct fs_walk_ctx_s fs_walk_ctx;
+
+typedef struct fs_walk_job_s {
+    uv_work_t req;
+    fs_walk_ctx *ctx;
+    char *path;
+    int error;
+    fs_walk_entry *entries;
+    size_t nentries;
+    Bool has_dirstat;
+    uv_stat_t dirstat;
+    struct fs_walk_job_s *next;
+} fs_walk_job;
+
+struct fs_walk_ctx_s {
+    Loop *loop;
+    PyObject *callback;
+    PyObject *visited;
+    Bool stat;
+    Bool follow_symlinks;
+    int max_parallel;
+    int active;
+    fs_walk_job *head;
+    fs_walk_job *tail;
+};
+
+struct fs_writer_record_s {
+    Py_buffer view;
+    PyObject *callback;
+    struct fs_writer_record_s *next;
+};
+
+/* Upper bound for the number of records coalesced into a single write */
+#define PYUV_WRITER_MAX_RECORDS 1024
+
+typedef struct {
+    uv_work_t req;
+    FSRequest *fs_req;
+    PyObject *progress;
+    uv_file out_fd;
+    uv_file in_fd;
+    int64_t offset;
+    uint64_t length;
+    uint64_t sent;
+    int64_t result;
+} fs_sendfile_ctx;
+
+typedef struct {
+    uv_work_t req;
+    MMap *mmap;
+    PyObject *callback;
+    char *addr;
+    size_t len;
+    int advice;
+    int result;
+} fs_mmap_advise_ctx;
 
 /* If true, st_?time is float */
 static int _stat_float_times = 1;
@@ -50,13 +194,106 @@ stat_to_pyobj(const uv_stat_t *st, PyObject *stat_data) {
 }
 
 
+/*
+ * Run a uv_fs_* function. When no callback was given the operation is performed synchronously,
+ * so the GIL is released while the system call runs. The call must not touch any Python objects.
+ */
+#define PYUV_FS_RUN(err, callback, fname, ...)                                      \
+    do {                                                                            \
+        if ((callback) != Py_None) {                                                \
+            err = fname(__VA_ARGS__, pyuv__process_fs_req);                         \
+        } else {                                                                    \
+            Py_BEGIN_ALLOW_THREADS                                                  \
+            err = fname(__VA_ARGS__, NULL);                                         \
+            Py_END_ALLOW_THREADS                                                    \
+        }                                                                           \
+    } while (0)
+
+
+static void
+pyuv__fs_release_buffers(FSRequest *fs_req)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < fs_req->view_count; i++) {
+        PyBuffer_Release(&fs_req->views[i]);
+    }
+    PyMem_Free(fs_req->views);
+    fs_req->views = NULL;
+    fs_req->view_count = 0;
+}
+
+
+/*
+ * Get a buffer view for the given object or for each object in the given sequence and store
+ * them in the request. The returned uv_buf_t array must be freed by the caller with PyMem_Free.
+ */
+static uv_buf_t *
+pyuv__fs_get_buffers(FSRequest *fs_req, PyObject *buffers, int flags)
+{
+    PyObject *buffers_fast, *item;
+    Py_ssize_t i, count;
+    uv_buf_t *bufs;
+
+    ASSERT(fs_req->views == NULL);
+
+    if (PyObject_CheckBuffer(buffers)) {
+        buffers_fast = PyTuple_Pack(1, buffers);
+    } else {
+        buffers_fast = PySequence_Fast(buffers, "buffers must be a buffer or an iterable of buffers");
+    }
+    if (buffers_fast == NULL) {
+        return NULL;
+    }
+
+    count = PySequence_Fast_GET_SIZE(buffers_fast);
+    if (count == 0) {
+        PyErr_SetString(PyExc_ValueError, "iterable is empty");
+        Py_DECREF(buffers_fast);
+        return NULL;
+    }
+    if (count > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "iterable is too long");
+        Py_DECREF(buffers_fast);
+        return NULL;
+    }
+
+    bufs = PyMem_Malloc(sizeof(uv_buf_t) * count);
+    fs_req->views = PyMem_Malloc(sizeof(Py_buffer) * count);
+    if (!bufs || !fs_req->views) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < count; i++) {
+        item = PySequence_Fast_GET_ITEM(buffers_fast, i);
+        if (PyObject_GetBuffer(item, &fs_req->views[i], flags) != 0) {
+            goto error;
+        }
+        fs_req->view_count++;
+        bufs[i] = uv_buf_init(fs_req->views[i].buf, fs_req->views[i].len);
+    }
+
+    Py_DECREF(buffers_fast);
+    return bufs;
+
+error:
+    if (fs_req->views) {
+        pyuv__fs_release_buffers(fs_req);
+    }
+    PyMem_Free(bufs);
+    Py_DECREF(buffers_fast);
+    return NULL;
+}
+
+
 /*
  * NOTE: This function is called either by libuv as a callback or by us when a synchronous
- * operation is performed.
+ * operation is performed, in which case the GIL has already been reacquired.
  */
 static void
 pyuv__process_fs_req(uv_fs_t* req) {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->loop);
     Loop *loop;
     FSRequest *fs_req;
     PyObject *result, *errorno, *r, *path, *item;
@@ -121,23 +358,31 @@ pyuv__process_fs_req(uv_fs_t* req) {
                     PyErr_Clear();
                     PYUV_SET_NONE(r);
                 }
-                PyBuffer_Release(&fs_req->view);
                 break;
             case UV_FS_OPEN:
-            case UV_FS_SENDFILE:
                 r = PyInt_FromLong((long)req->result);
                 if (!r) {
                     PyErr_Clear();
                     PYUV_SET_NONE(r);
                 }
                 break;
+            case UV_FS_SENDFILE:
+                r = PyInt_FromSsize_t((Py_ssize_t)req->result);
+                if (!r) {
+                    PyErr_Clear();
+                    PYUV_SET_NONE(r);
+                }
+                break;
             case UV_FS_READ:
-                r = PyBytes_FromStringAndSize(fs_req->buf.base, req->result);
+                if (fs_req->views != NULL) {
+                    r = PyInt_FromLong((long)req->result);
+                } else {
+                    r = PyBytes_FromStringAndSize(fs_req->buf.base, req->result);
+                }
                 if (!r) {
                     PyErr_Clear();
                     PYUV_SET_NONE(r);
                 }
-                PyMem_Free(fs_req->buf.base);
                 break;
             case UV_FS_SCANDIR:
                 r = PyList_New(0);
@@ -165,6 +410,17 @@ pyuv__process_fs_req(uv_fs_t* req) {
         }
     }
 
+    /* Release the buffers, also when the operation failed */
+    if (req->fs_type == UV_FS_READ || req->fs_type == UV_FS_WRITE) {
+        if (fs_req->views != NULL) {
+            pyuv__fs_release_buffers(fs_req);
+        } else if (req->fs_type == UV_FS_READ) {
+            PyMem_Free(fs_req->buf.base);
+        } else {
+            PyBuffer_Release(&fs_req->view);
+        }
+    }
+
     /* Save result, path and error in the FSRequest object */
     fs_req->path = path;
     fs_req->result = r;
@@ -182,7 +438,7 @@ pyuv__process_fs_req(uv_fs_t* req) {
     UV_REQUEST(fs_req) = NULL;
     Py_DECREF(fs_req);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -214,10 +470,12 @@ pyuv__fs_stat(PyObject *args, PyObject *kwargs, int type)
         return NULL;
     }
 
-    if (type == UV_FS_STAT) {
-        err = uv_fs_stat(loop->uv_loop, &fs_req->req, path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, type, -1, path, 0, 0, NULL, 0, 0) == 0) {
+        err = 0;
+    } else if (type == UV_FS_STAT) {
+        PYUV_FS_RUN(err, callback, uv_fs_stat, loop->uv_loop, &fs_req->req, path);
     } else {
-        err = uv_fs_lstat(loop->uv_loop, &fs_req->req, path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+        PYUV_FS_RUN(err, callback, uv_fs_lstat, loop->uv_loop, &fs_req->req, path);
     }
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
@@ -284,7 +542,11 @@ FS_func_fstat(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_fstat(loop->uv_loop, &fs_req->req, (uv_file)fd, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_FSTAT, (uv_file)fd, NULL, 0, 0, NULL, 0, 0) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_fstat, loop->uv_loop, &fs_req->req, (uv_file)fd);
+    }
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -334,7 +596,7 @@ FS_func_unlink(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_unlink(loop->uv_loop, &fs_req->req, path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_unlink, loop->uv_loop, &fs_req->req, path);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -384,7 +646,7 @@ FS_func_mkdir(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_mkdir(loop->uv_loop, &fs_req->req, path, mode, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_mkdir, loop->uv_loop, &fs_req->req, path, mode);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -434,7 +696,7 @@ FS_func_rmdir(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_rmdir(loop->uv_loop, &fs_req->req, path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_rmdir, loop->uv_loop, &fs_req->req, path);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -484,7 +746,7 @@ FS_func_rename(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_rename(loop->uv_loop, &fs_req->req, path, new_path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_rename, loop->uv_loop, &fs_req->req, path, new_path);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -534,7 +796,7 @@ FS_func_chmod(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_chmod(loop->uv_loop, &fs_req->req, path, mode, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_chmod, loop->uv_loop, &fs_req->req, path, mode);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -584,7 +846,7 @@ FS_func_fchmod(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_fchmod(loop->uv_loop, &fs_req->req, (uv_file)fd, mode, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_fchmod, loop->uv_loop, &fs_req->req, (uv_file)fd, mode);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -634,7 +896,7 @@ FS_func_link(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_link(loop->uv_loop, &fs_req->req, path, new_path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_link, loop->uv_loop, &fs_req->req, path, new_path);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -684,7 +946,7 @@ FS_func_symlink(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_symlink(loop->uv_loop, &fs_req->req, path, new_path, flags, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_symlink, loop->uv_loop, &fs_req->req, path, new_path, flags);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -734,7 +996,7 @@ FS_func_readlink(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_readlink(loop->uv_loop, &fs_req->req, path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_readlink, loop->uv_loop, &fs_req->req, path);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -784,7 +1046,7 @@ FS_func_chown(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_chown(loop->uv_loop, &fs_req->req, path, uid, gid, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_chown, loop->uv_loop, &fs_req->req, path, uid, gid);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -834,7 +1096,7 @@ FS_func_fchown(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_fchown(loop->uv_loop, &fs_req->req, (uv_file)fd, uid, gid, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_fchown, loop->uv_loop, &fs_req->req, (uv_file)fd, uid, gid);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -884,7 +1146,11 @@ FS_func_open(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_open(loop->uv_loop, &fs_req->req, path, flags, mode, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_OPEN, -1, path, flags, mode, NULL, 0, 0) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_open, loop->uv_loop, &fs_req->req, path, flags, mode);
+    }
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -934,7 +1200,11 @@ FS_func_close(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_close(loop->uv_loop, &fs_req->req, (uv_file)fd, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_CLOSE, (uv_file)fd, NULL, 0, 0, NULL, 0, 0) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_close, loop->uv_loop, &fs_req->req, (uv_file)fd);
+    }
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -997,7 +1267,11 @@ FS_func_read(PyObject *obj, PyObject *args, PyObject *kwargs)
     fs_req->buf.base = buf;
     fs_req->buf.len = length;
 
-    err = uv_fs_read(loop->uv_loop, &fs_req->req, (uv_file)fd, &fs_req->buf, 1, offset, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_READ, (uv_file)fd, NULL, 0, 0, &fs_req->buf, 1, offset) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_read, loop->uv_loop, &fs_req->req, (uv_file)fd, &fs_req->buf, 1, offset);
+    }
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         PyMem_Free(buf);
@@ -1057,7 +1331,11 @@ FS_func_write(PyObject *obj, PyObject *args, PyObject *kwargs)
     memcpy(&fs_req->view, &view, sizeof(Py_buffer));
     buf = uv_buf_init(fs_req->view.buf, fs_req->view.len);
 
-    err = uv_fs_write(loop->uv_loop, &fs_req->req, (uv_file)fd, &buf, 1, offset, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_WRITE, (uv_file)fd, NULL, 0, 0, &buf, 1, offset) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_write, loop->uv_loop, &fs_req->req, (uv_file)fd, &buf, 1, offset);
+    }
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         PyBuffer_Release(&fs_req->view);
@@ -1081,21 +1359,23 @@ FS_func_write(PyObject *obj, PyObject *args, PyObject *kwargs)
 
 
 static PyObject *
-FS_func_fsync(PyObject *obj, PyObject *args, PyObject *kwargs)
+FS_func_readinto(PyObject *obj, PyObject *args, PyObject *kwargs)
 {
     int err;
+    int64_t offset;
     long fd;
     Loop *loop;
     FSRequest *fs_req;
-    PyObject *callback, *ret;
+    PyObject *buffers, *callback, *ret;
+    uv_buf_t *bufs;
 
-    static char *kwlist[] = {"loop", "fd", "callback", NULL};
+    static char *kwlist[] = {"loop", "fd", "buffers", "offset", "callback", NULL};
 
     UNUSED_ARG(obj);
     fs_req = NULL;
     callback = Py_None;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!l|O:fsync", kwlist, &LoopType, &loop, &fd, &callback)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!lOL|O:readinto", kwlist, &LoopType, &loop, &fd, &buffers, &offset, &callback)) {
         return NULL;
     }
 
@@ -1109,9 +1389,22 @@ FS_func_fsync(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_fsync(loop->uv_loop, &fs_req->req, (uv_file)fd, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    bufs = pyuv__fs_get_buffers(fs_req, buffers, PyBUF_WRITABLE);
+    if (!bufs) {
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    /* libuv copies the uv_buf_t array, the memory it points to is kept alive by the views */
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_READ, (uv_file)fd, NULL, 0, 0, bufs, (unsigned int)fs_req->view_count, offset) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_read, loop->uv_loop, &fs_req->req, (uv_file)fd, bufs, (unsigned int)fs_req->view_count, offset);
+    }
+    PyMem_Free(bufs);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        pyuv__fs_release_buffers(fs_req);
         Py_DECREF(fs_req);
         return NULL;
     }
@@ -1131,21 +1424,23 @@ FS_func_fsync(PyObject *obj, PyObject *args, PyObject *kwargs)
 
 
 static PyObject *
-FS_func_fdatasync(PyObject *obj, PyObject *args, PyObject *kwargs)
+FS_func_writev(PyObject *obj, PyObject *args, PyObject *kwargs)
 {
     int err;
+    int64_t offset;
     long fd;
     Loop *loop;
     FSRequest *fs_req;
-    PyObject *callback, *ret;
+    PyObject *buffers, *callback, *ret;
+    uv_buf_t *bufs;
 
-    static char *kwlist[] = {"loop", "fd", "callback", NULL};
+    static char *kwlist[] = {"loop", "fd", "buffers", "offset", "callback", NULL};
 
     UNUSED_ARG(obj);
     fs_req = NULL;
     callback = Py_None;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!l|O:fdatasync", kwlist, &LoopType, &loop, &fd, &callback)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!lOL|O:writev", kwlist, &LoopType, &loop, &fd, &buffers, &offset, &callback)) {
         return NULL;
     }
 
@@ -1159,9 +1454,21 @@ FS_func_fdatasync(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_fdatasync(loop->uv_loop, &fs_req->req, (uv_file)fd, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    bufs = pyuv__fs_get_buffers(fs_req, buffers, PyBUF_SIMPLE);
+    if (!bufs) {
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_WRITE, (uv_file)fd, NULL, 0, 0, bufs, (unsigned int)fs_req->view_count, offset) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_write, loop->uv_loop, &fs_req->req, (uv_file)fd, bufs, (unsigned int)fs_req->view_count, offset);
+    }
+    PyMem_Free(bufs);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        pyuv__fs_release_buffers(fs_req);
         Py_DECREF(fs_req);
         return NULL;
     }
@@ -1174,165 +1481,2137 @@ FS_func_fdatasync(PyObject *obj, PyObject *args, PyObject *kwargs)
         pyuv__process_fs_req(&fs_req->req);
         Py_INCREF(fs_req->result);
         ret = fs_req->result;
+        /* buffer views are released in pyuv__process_fs_req */
         Py_DECREF(fs_req);
         return ret;
     }
 }
 
 
-static PyObject *
-FS_func_ftruncate(PyObject *obj, PyObject *args, PyObject *kwargs)
+/*
+ * Whole file operations. The entire open / read or write / close sequence runs in a single
+ * threadpool job (or synchronously, without the GIL) using synchronous uv_fs_* calls, which don't
+ * touch the loop. These functions run without the GIL, so they must not touch Python objects.
+ */
+static void
+pyuv__fs_read_file(uv_loop_t *loop, FSRequest *fs_req)
 {
     int err;
-    int64_t offset;
-    long fd;
-    Loop *loop;
-    FSRequest *fs_req;
-    PyObject *callback, *ret;
-
-    static char *kwlist[] = {"loop", "fd", "offset", "callback", NULL};
-
-    UNUSED_ARG(obj);
-    fs_req = NULL;
-    callback = Py_None;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!lL|O:ftruncate", kwlist, &LoopType, &loop, &fd, &offset, &callback)) {
-        return NULL;
-    }
+    uv_fs_t req;
+    uv_file fd;
+    uv_buf_t buf;
+    char *data, *tmp;
+    size_t size, len, chunk;
 
-    if (callback != Py_None && !PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "a callable is required");
-        return NULL;
-    }
+    data = NULL;
+    len = 0;
 
-    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
-    if (!fs_req) {
-        return NULL;
+    err = uv_fs_open(loop, &req, fs_req->file.path, O_RDONLY, 0, NULL);
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+        fs_req->file.result = err;
+        return;
     }
+    fd = (uv_file)err;
 
-    err = uv_fs_ftruncate(loop->uv_loop, &fs_req->req, (uv_file)fd, offset, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    err = uv_fs_fstat(loop, &req, fd, NULL);
+    size = (size_t)req.statbuf.st_size;
+    uv_fs_req_cleanup(&req);
     if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_FSError);
-        Py_DECREF(fs_req);
-        return NULL;
+        goto end;
+    }
+
+    /* Leave room to detect EOF without growing the buffer. Files which report a size of 0 (such
+     * as the ones in /proc) are read in growing chunks.
+     */
+    size = size > 0 ? size + 1 : PYUV_BUFFER_SIZE;
+    data = malloc(size);
+    if (!data) {
+        err = UV_ENOMEM;
+        goto end;
+    }
+
+    for (;;) {
+        if (len == size) {
+            tmp = realloc(data, size * 2);
+            if (!tmp) {
+                err = UV_ENOMEM;
+                goto end;
+            }
+            data = tmp;
+            size *= 2;
+        }
+        chunk = size - len;
+        if (chunk > UINT_MAX) {
+            chunk = UINT_MAX;
+        }
+        buf = uv_buf_init(data + len, (unsigned int)chunk);
+        err = uv_fs_read(loop, &req, fd, &buf, 1, (int64_t)len, NULL);
+        uv_fs_req_cleanup(&req);
+        if (err <= 0) {
+            break;
+        }
+        len += err;
     }
 
-    Py_INCREF(fs_req);
-    if (callback != Py_None) {
-        /* No need to cleanup, it will be done in the callback */
-        return (PyObject *)fs_req;
+end:
+    uv_fs_close(loop, &req, fd, NULL);
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+        free(data);
+        fs_req->file.result = err;
     } else {
-        pyuv__process_fs_req(&fs_req->req);
-        Py_INCREF(fs_req->result);
-        ret = fs_req->result;
-        Py_DECREF(fs_req);
-        return ret;
+        fs_req->file.data = data;
+        fs_req->file.len = len;
+        fs_req->file.result = len;
     }
 }
 
 
-static PyObject *
-FS_func_scandir(PyObject *obj, PyObject *args, PyObject *kwargs)
+/* Make a rename durable by syncing the directory holding the file */
+static int
+pyuv__fs_sync_parent(uv_loop_t *loop, const char *path)
 {
-    int err;
-    char *path;
-    Loop *loop;
-    FSRequest *fs_req;
-    PyObject *callback, *ret;
+#ifndef PYUV_WINDOWS
+    int err, r;
+    uv_fs_t req;
+    uv_file fd;
+    char *dir, *sep;
+
+    dir = malloc(strlen(path) + 2);
+    if (!dir) {
+        return UV_ENOMEM;
+    }
+    strcpy(dir, path);
+    sep = strrchr(dir, '/');
+    if (sep == NULL) {
+        strcpy(dir, ".");
+    } else if (sep == dir) {
+        dir[1] = '\0';
+    } else {
+        *sep = '\0';
+    }
 
-    static char *kwlist[] = {"loop", "path", "callback", NULL};
+    err = uv_fs_open(loop, &req, dir, O_RDONLY, 0, NULL);
+    uv_fs_req_cleanup(&req);
+    free(dir);
+    if (err < 0) {
+        return err;
+    }
+    fd = (uv_file)err;
 
-    UNUSED_ARG(obj);
-    fs_req = NULL;
-    callback = Py_None;
+    err = uv_fs_fsync(loop, &req, fd, NULL);
+    uv_fs_req_cleanup(&req);
+    r = uv_fs_close(loop, &req, fd, NULL);
+    uv_fs_req_cleanup(&req);
+    return err < 0 ? err : r;
+#else
+    /* directories can't be synced on Windows */
+    UNUSED_ARG(loop);
+    UNUSED_ARG(path);
+    return 0;
+#endif
+}
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!s|O:scandir", kwlist, &LoopType, &loop, &path, &callback)) {
-        return NULL;
+
+static void
+pyuv__fs_write_file(uv_loop_t *loop, FSRequest *fs_req)
+{
+    int err, r, i;
+    uv_fs_t req;
+    uv_file fd;
+    uv_buf_t buf;
+    char *tmp_path;
+    size_t len, chunk, tmp_path_len;
+
+    tmp_path = NULL;
+    len = 0;
+
+    if (fs_req->file.atomic) {
+        /* Write to a temporary file in the same directory and rename it over the target */
+        tmp_path_len = strlen(fs_req->file.path) + 16;
+        tmp_path = malloc(tmp_path_len);
+        if (!tmp_path) {
+            fs_req->file.result = UV_ENOMEM;
+            return;
+        }
+        err = UV_EEXIST;
+        for (i = 0; i < 16 && err == UV_EEXIST; i++) {
+            PyOS_snprintf(tmp_path, tmp_path_len, "%s.%08x.tmp", fs_req->file.path, (unsigned int)(uv_hrtime() + i));
+            err = uv_fs_open(loop, &req, tmp_path, O_WRONLY|O_CREAT|O_EXCL, fs_req->file.mode, NULL);
+            uv_fs_req_cleanup(&req);
+        }
+    } else {
+        err = uv_fs_open(loop, &req, fs_req->file.path, fs_req->file.flags, fs_req->file.mode, NULL);
+        uv_fs_req_cleanup(&req);
+    }
+    if (err < 0) {
+        free(tmp_path);
+        fs_req->file.result = err;
+        return;
     }
+    fd = (uv_file)err;
+    err = 0;
 
-    if (callback != Py_None && !PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "a callable is required");
-        return NULL;
+    while (len < fs_req->file.len) {
+        chunk = fs_req->file.len - len;
+        if (chunk > UINT_MAX) {
+            chunk = UINT_MAX;
+        }
+        buf = uv_buf_init(fs_req->file.data + len, (unsigned int)chunk);
+        err = uv_fs_write(loop, &req, fd, &buf, 1, -1, NULL);
+        uv_fs_req_cleanup(&req);
+        if (err < 0) {
+            break;
+        }
+        len += err;
+        err = 0;
     }
 
-    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
-    if (!fs_req) {
-        return NULL;
+    if (err == 0 && (fs_req->file.fsync || fs_req->file.atomic)) {
+        err = uv_fs_fsync(loop, &req, fd, NULL);
+        uv_fs_req_cleanup(&req);
     }
 
-    err = uv_fs_scandir(loop->uv_loop, &fs_req->req, path, 0, (callback != Py_None) ? pyuv__process_fs_req : NULL);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_FSError);
-        Py_DECREF(fs_req);
-        return NULL;
+    r = uv_fs_close(loop, &req, fd, NULL);
+    uv_fs_req_cleanup(&req);
+    if (err == 0) {
+        err = r;
     }
 
-    Py_INCREF(fs_req);
-    if (callback != Py_None) {
-        /* No need to cleanup, it will be done in the callback */
-        return (PyObject *)fs_req;
-    } else {
-        pyuv__process_fs_req(&fs_req->req);
-        Py_INCREF(fs_req->result);
-        ret = fs_req->result;
-        Py_DECREF(fs_req);
-        return ret;
+    if (tmp_path) {
+        if (err == 0) {
+            err = uv_fs_rename(loop, &req, tmp_path, fs_req->file.path, NULL);
+            uv_fs_req_cleanup(&req);
+            if (err == 0 && fs_req->file.fsync) {
+                err = pyuv__fs_sync_parent(loop, fs_req->file.path);
+            }
+        }
+        if (err < 0) {
+            uv_fs_unlink(loop, &req, tmp_path, NULL);
+            uv_fs_req_cleanup(&req);
+        }
+        free(tmp_path);
     }
+
+    fs_req->file.result = err < 0 ? err : (ssize_t)len;
 }
 
 
-static PyObject *
-FS_func_sendfile(PyObject *obj, PyObject *args, PyObject *kwargs)
+/*
+ * Copy a file, trying a reflink first, then copy_file_range and finally sendfile, which also
+ * picks up anything the previous ones left behind (or files which report a size of 0).
+ */
+static void
+pyuv__fs_copyfile(uv_loop_t *loop, FSRequest *fs_req)
 {
-    int err, length;
-    int64_t in_offset;
-    long out_fd, in_fd;
-    Loop *loop;
-    FSRequest *fs_req;
-    PyObject *callback, *ret;
-
-    static char *kwlist[] = {"loop", "out_fd", "in_fd", "in_offset", "length", "callback", NULL};
+    int err, r, flags;
+    Bool same;
+    uv_fs_t req;
+    uv_file in_fd, out_fd;
+    uint64_t size, mode, len, dev, ino;
+#ifdef __linux__
+    ssize_t n;
+#endif
 
-    UNUSED_ARG(obj);
-    fs_req = NULL;
-    callback = Py_None;
+    len = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!llLi|O:sendfile", kwlist, &LoopType, &loop, &out_fd, &in_fd, &in_offset, &length, &callback)) {
-        return NULL;
+    err = uv_fs_open(loop, &req, fs_req->file.path, O_RDONLY, 0, NULL);
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+        fs_req->file.result = err;
+        return;
     }
+    in_fd = (uv_file)err;
 
-    if (callback != Py_None && !PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "a callable is required");
-        return NULL;
+    err = uv_fs_fstat(loop, &req, in_fd, NULL);
+    size = req.statbuf.st_size;
+    mode = req.statbuf.st_mode;
+    dev = req.statbuf.st_dev;
+    ino = req.statbuf.st_ino;
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+        goto close_in;
     }
 
-    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
-    if (!fs_req) {
-        return NULL;
+    /* Not truncated yet, the destination could be the source itself */
+    flags = O_WRONLY | O_CREAT;
+    if (fs_req->file.flags & UV_FS_COPYFILE_EXCL) {
+        flags |= O_EXCL;
     }
-
-    err = uv_fs_sendfile(loop->uv_loop, &fs_req->req, (uv_file)out_fd, (uv_file)in_fd, in_offset, length, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    err = uv_fs_open(loop, &req, fs_req->file.new_path, flags, (int)(mode & 0777), NULL);
+    uv_fs_req_cleanup(&req);
     if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_FSError);
-        Py_DECREF(fs_req);
-        return NULL;
+        goto close_in;
     }
+    out_fd = (uv_file)err;
 
-    Py_INCREF(fs_req);
-    if (callback != Py_None) {
-        /* No need to cleanup, it will be done in the callback */
-        return (PyObject *)fs_req;
-    } else {
-        pyuv__process_fs_req(&fs_req->req);
-        Py_INCREF(fs_req->result);
-        ret = fs_req->result;
-        Py_DECREF(fs_req);
-        return ret;
+    err = uv_fs_fstat(loop, &req, out_fd, NULL);
+    same = req.statbuf.st_dev == dev && req.statbuf.st_ino == ino;
+    uv_fs_req_cleanup(&req);
+    if (err < 0 || same) {
+        /* copying a file onto itself is a no-op, like in libuv */
+        goto close_out;
     }
-}
 
+    err = uv_fs_ftruncate(loop, &req, out_fd, 0, NULL);
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+        goto close_out;
+    }
 
-static PyObject *
+    /* The destination may have existed already, with other permissions */
+    err = uv_fs_fchmod(loop, &req, out_fd, (int)(mode & 07777), NULL);
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+        goto close_out;
+    }
+
+#ifdef __linux__
+    if (ioctl(out_fd, FICLONE, in_fd) == 0) {
+        len = size;
+        goto close_out;
+    }
+    if (fs_req->file.flags & UV_FS_COPYFILE_FICLONE_FORCE) {
+        err = -errno;
+        goto close_out;
+    }
+#ifdef __NR_copy_file_range
+    while (len < size) {
+        n = syscall(__NR_copy_file_range, in_fd, NULL, out_fd, NULL, (size_t)(size - len), 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* not supported for this kernel or pair of filesystems, sendfile will do */
+            if (len == 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+                break;
+            }
+            err = -errno;
+            goto close_out;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += n;
+    }
+#endif
+#else
+    if (fs_req->file.flags & UV_FS_COPYFILE_FICLONE_FORCE) {
+        err = UV_ENOSYS;
+        goto close_out;
+    }
+#endif
+
+    for (;;) {
+        err = uv_fs_sendfile(loop, &req, out_fd, in_fd, (int64_t)len, PYUV_SENDFILE_CHUNK, NULL);
+        uv_fs_req_cleanup(&req);
+        if (err <= 0) {
+            break;
+        }
+        len += err;
+    }
+
+close_out:
+    r = uv_fs_close(loop, &req, out_fd, NULL);
+    uv_fs_req_cleanup(&req);
+    if (err == 0) {
+        err = r;
+    }
+    if (err < 0) {
+        uv_fs_unlink(loop, &req, fs_req->file.new_path, NULL);
+        uv_fs_req_cleanup(&req);
+    }
+
+close_in:
+    uv_fs_close(loop, &req, in_fd, NULL);
+    uv_fs_req_cleanup(&req);
+
+    fs_req->file.result = err < 0 ? err : (ssize_t)len;
+}
+
+
+static void
+pyuv__fs_file_run(uv_loop_t *loop, FSRequest *fs_req)
+{
+    if (fs_req->file.type == UV_FS_READ) {
+        pyuv__fs_read_file(loop, fs_req);
+    } else if (fs_req->file.type == PYUV_FS_COPYFILE) {
+        pyuv__fs_copyfile(loop, fs_req);
+    } else {
+        pyuv__fs_write_file(loop, fs_req);
+    }
+}
+
+
+static void
+pyuv__fs_file_work_cb(uv_work_t *req)
+{
+    FSRequest *fs_req;
+
+    ASSERT(req);
+    fs_req = PYUV_CONTAINER_OF(req, FSRequest, work_req);
+    pyuv__fs_file_run(req->loop, fs_req);
+}
+
+
+/*
+ * NOTE: Like pyuv__process_fs_req this is called either from the threadpool done callback or by
+ * us after a synchronous operation.
+ */
+static void
+pyuv__process_fs_file_req(FSRequest *fs_req)
+{
+    Loop *loop;
+    PyObject *result, *errorno, *r, *path;
+    int gstate;
+
+    loop = REQUEST(fs_req)->loop;
+    gstate = pyuv__gil_ensure(loop->uv_loop);
+
+    path = Py_BuildValue("s", fs_req->file.path);
+    if (!path) {
+        PyErr_Clear();
+        PYUV_SET_NONE(path);
+    }
+
+    if (fs_req->file.result < 0) {
+        errorno = PyInt_FromLong((long)fs_req->file.result);
+        PYUV_SET_NONE(r);
+    } else {
+        PYUV_SET_NONE(errorno);
+        if (fs_req->file.type == UV_FS_READ) {
+            r = PyBytes_FromStringAndSize(fs_req->file.data, fs_req->file.len);
+        } else {
+            r = PyInt_FromSsize_t(fs_req->file.result);
+        }
+        if (!r) {
+            PyErr_Clear();
+            PYUV_SET_NONE(r);
+        }
+    }
+
+    if (fs_req->file.type == UV_FS_READ) {
+        free(fs_req->file.data);
+    } else if (fs_req->file.type == UV_FS_WRITE) {
+        PyBuffer_Release(&fs_req->view);
+    }
+    fs_req->file.data = NULL;
+    PyMem_Free(fs_req->file.path);
+    fs_req->file.path = NULL;
+    PyMem_Free(fs_req->file.new_path);
+    fs_req->file.new_path = NULL;
+
+    /* Save result, path and error in the FSRequest object */
+    fs_req->path = path;
+    fs_req->result = r;
+    fs_req->error = errorno;
+
+    if (fs_req->callback != Py_None) {
+        result = PyObject_CallFunctionObjArgs(fs_req->callback, fs_req, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(loop);
+        }
+        Py_XDECREF(result);
+    }
+
+    UV_REQUEST(fs_req) = NULL;
+    Py_DECREF(fs_req);
+
+    pyuv__gil_release(gstate);
+}
+
+
+static void
+pyuv__fs_file_done_cb(uv_work_t *req, int status)
+{
+    FSRequest *fs_req;
+
+    ASSERT(req);
+    fs_req = PYUV_CONTAINER_OF(req, FSRequest, work_req);
+    if (status == UV_ECANCELED) {
+        fs_req->file.result = status;
+    }
+    pyuv__process_fs_file_req(fs_req);
+}
+
+
+static PyObject *
+pyuv__fs_file_submit(Loop *loop, FSRequest *fs_req, const char *path, PyObject *callback)
+{
+    int err;
+    size_t path_len;
+    PyObject *ret;
+
+    path_len = strlen(path) + 1;
+    fs_req->file.path = PyMem_Malloc(path_len);
+    if (!fs_req->file.path) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    memcpy(fs_req->file.path, path, path_len);
+
+    if (callback != Py_None) {
+        UV_REQUEST(fs_req) = (uv_req_t *)&fs_req->work_req;
+        err = uv_queue_work(loop->uv_loop, &fs_req->work_req, pyuv__fs_file_work_cb, pyuv__fs_file_done_cb);
+        if (err < 0) {
+            RAISE_UV_EXCEPTION(err, PyExc_FSError);
+            goto error;
+        }
+        /* No need to cleanup, it will be done in the callback */
+        Py_INCREF(fs_req);
+        return (PyObject *)fs_req;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    pyuv__fs_file_run(loop->uv_loop, fs_req);
+    Py_END_ALLOW_THREADS
+
+    Py_INCREF(fs_req);
+    pyuv__process_fs_file_req(fs_req);
+    if (fs_req->error != Py_None) {
+        RAISE_UV_EXCEPTION(fs_req->file.result, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+    Py_INCREF(fs_req->result);
+    ret = fs_req->result;
+    Py_DECREF(fs_req);
+    return ret;
+
+error:
+    UV_REQUEST(fs_req) = NULL;
+    if (fs_req->file.type == UV_FS_WRITE) {
+        PyBuffer_Release(&fs_req->view);
+    }
+    PyMem_Free(fs_req->file.path);
+    fs_req->file.path = NULL;
+    PyMem_Free(fs_req->file.new_path);
+    fs_req->file.new_path = NULL;
+    Py_DECREF(fs_req);
+    return NULL;
+}
+
+
+static PyObject *
+FS_func_read_file(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    char *path;
+    Loop *loop;
+    FSRequest *fs_req;
+    PyObject *callback;
+
+    static char *kwlist[] = {"loop", "path", "callback", NULL};
+
+    UNUSED_ARG(obj);
+    callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!s|O:read_file", kwlist, &LoopType, &loop, &path, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    fs_req->file.type = UV_FS_READ;
+
+    return pyuv__fs_file_submit(loop, fs_req, path, callback);
+}
+
+
+static PyObject *
+FS_func_write_file(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int flags, mode, fsync, atomic;
+    char *path;
+    Loop *loop;
+    FSRequest *fs_req;
+    PyObject *callback;
+    Py_buffer view;
+
+    static char *kwlist[] = {"loop", "path", "data", "flags", "mode", "fsync", "atomic", "callback", NULL};
+
+    UNUSED_ARG(obj);
+    callback = Py_None;
+    flags = O_WRONLY | O_CREAT | O_TRUNC;
+    mode = 0644;
+    fsync = 0;
+    atomic = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!s"PYUV_BYTES"*|iiiiO:write_file", kwlist, &LoopType, &loop, &path, &view, &flags, &mode, &fsync, &atomic, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    memcpy(&fs_req->view, &view, sizeof(Py_buffer));
+    fs_req->file.type = UV_FS_WRITE;
+    fs_req->file.flags = flags;
+    fs_req->file.mode = mode;
+    fs_req->file.fsync = fsync ? True : False;
+    fs_req->file.atomic = atomic ? True : False;
+    fs_req->file.data = fs_req->view.buf;
+    fs_req->file.len = fs_req->view.len;
+
+    return pyuv__fs_file_submit(loop, fs_req, path, callback);
+}
+
+
+static PyObject *
+FS_func_copyfile(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int flags;
+    char *path, *new_path;
+    size_t new_path_len;
+    Loop *loop;
+    FSRequest *fs_req;
+    PyObject *callback;
+
+    static char *kwlist[] = {"loop", "path", "new_path", "flags", "callback", NULL};
+
+    UNUSED_ARG(obj);
+    callback = Py_None;
+    flags = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!ss|iO:copyfile", kwlist, &LoopType, &loop, &path, &new_path, &flags, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    if (flags & ~(UV_FS_COPYFILE_EXCL | UV_FS_COPYFILE_FICLONE_FORCE)) {
+        PyErr_SetString(PyExc_ValueError, "invalid flags");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    new_path_len = strlen(new_path) + 1;
+    fs_req->file.new_path = PyMem_Malloc(new_path_len);
+    if (!fs_req->file.new_path) {
+        Py_DECREF(fs_req);
+        return PyErr_NoMemory();
+    }
+    memcpy(fs_req->file.new_path, new_path, new_path_len);
+    fs_req->file.type = PYUV_FS_COPYFILE;
+    fs_req->file.flags = flags;
+
+    return pyuv__fs_file_submit(loop, fs_req, path, callback);
+}
+
+
+/*
+ * Batched operations. Paths point into the str / bytes objects held by ops_obj, which is an
+ * immutable tuple, so they stay valid while the chunks run without the GIL.
+ */
+static const struct {
+    const char *name;
+    uv_fs_type type;
+    const char *format;
+} pyuv__fs_batch_types[] = {
+    { "stat", UV_FS_STAT, "s:stat" },
+    { "lstat", UV_FS_LSTAT, "s:lstat" },
+    { "unlink", UV_FS_UNLINK, "s:unlink" },
+    { "mkdir", UV_FS_MKDIR, "s|i:mkdir" },
+    { "rmdir", UV_FS_RMDIR, "s:rmdir" },
+    { "rename", UV_FS_RENAME, "ss:rename" },
+    { "chmod", UV_FS_CHMOD, "si:chmod" },
+    { "access", UV_FS_ACCESS, "si:access" },
+    { NULL }
+};
+
+
+static int
+pyuv__fs_batch_parse(PyObject *item, fs_batch_op *op)
+{
+    int i;
+    char *name;
+    PyObject *args;
+
+    if (!PyArg_ParseTuple(item, "sO!:batch", &name, &PyTuple_Type, &args)) {
+        return -1;
+    }
+
+    for (i = 0; pyuv__fs_batch_types[i].name != NULL; i++) {
+        if (strcmp(name, pyuv__fs_batch_types[i].name) == 0) {
+            break;
+        }
+    }
+    if (pyuv__fs_batch_types[i].name == NULL) {
+        PyErr_Format(PyExc_ValueError, "unsupported batch operation: %s", name);
+        return -1;
+    }
+
+    op->type = pyuv__fs_batch_types[i].type;
+    op->new_path = NULL;
+    op->mode = 0777;
+    op->result = 0;
+
+    switch (op->type) {
+        case UV_FS_RENAME:
+            return PyArg_ParseTuple(args, pyuv__fs_batch_types[i].format, &op->path, &op->new_path) ? 0 : -1;
+        case UV_FS_MKDIR:
+        case UV_FS_CHMOD:
+        case UV_FS_ACCESS:
+            return PyArg_ParseTuple(args, pyuv__fs_batch_types[i].format, &op->path, &op->mode) ? 0 : -1;
+        default:
+            return PyArg_ParseTuple(args, pyuv__fs_batch_types[i].format, &op->path) ? 0 : -1;
+    }
+}
+
+
+/* Runs without the GIL */
+static void
+pyuv__fs_batch_run(uv_loop_t *loop, fs_batch_op *ops, Py_ssize_t start, Py_ssize_t end)
+{
+    Py_ssize_t i;
+    fs_batch_op *op;
+    uv_fs_t req;
+
+    for (i = start; i < end; i++) {
+        op = &ops[i];
+        switch (op->type) {
+            case UV_FS_STAT:
+                op->result = uv_fs_stat(loop, &req, op->path, NULL);
+                break;
+            case UV_FS_LSTAT:
+                op->result = uv_fs_lstat(loop, &req, op->path, NULL);
+                break;
+            case UV_FS_UNLINK:
+                op->result = uv_fs_unlink(loop, &req, op->path, NULL);
+                break;
+            case UV_FS_MKDIR:
+                op->result = uv_fs_mkdir(loop, &req, op->path, op->mode, NULL);
+                break;
+            case UV_FS_RMDIR:
+                op->result = uv_fs_rmdir(loop, &req, op->path, NULL);
+                break;
+            case UV_FS_RENAME:
+                op->result = uv_fs_rename(loop, &req, op->path, op->new_path, NULL);
+                break;
+            case UV_FS_CHMOD:
+                op->result = uv_fs_chmod(loop, &req, op->path, op->mode, NULL);
+                break;
+            case UV_FS_ACCESS:
+                op->result = uv_fs_access(loop, &req, op->path, op->mode, NULL);
+                break;
+            default:
+                ASSERT(!"unknown fs batch op type");
+                break;
+        }
+        if (op->result == 0 && (op->type == UV_FS_STAT || op->type == UV_FS_LSTAT)) {
+            memcpy(&op->statbuf, &req.statbuf, sizeof(uv_stat_t));
+        }
+        uv_fs_req_cleanup(&req);
+    }
+}
+
+
+static PyObject *
+pyuv__fs_batch_results(fs_batch_ctx *ctx)
+{
+    Py_ssize_t i;
+    fs_batch_op *op;
+    PyObject *results, *item, *r, *errorno;
+
+    results = PyList_New(ctx->count);
+    if (!results) {
+        return NULL;
+    }
+
+    for (i = 0; i < ctx->count; i++) {
+        op = &ctx->ops[i];
+        if (op->result < 0) {
+            errorno = PyInt_FromLong((long)op->result);
+            PYUV_SET_NONE(r);
+        } else {
+            PYUV_SET_NONE(errorno);
+            if (op->type == UV_FS_STAT || op->type == UV_FS_LSTAT) {
+                r = PyStructSequence_New(&StatResultType);
+                if (r) {
+                    stat_to_pyobj(&op->statbuf, r);
+                }
+            } else {
+                PYUV_SET_NONE(r);
+            }
+        }
+        if (!r || !errorno) {
+            Py_XDECREF(r);
+            Py_XDECREF(errorno);
+            Py_DECREF(results);
+            return NULL;
+        }
+        item = PyTuple_Pack(2, r, errorno);
+        Py_DECREF(r);
+        Py_DECREF(errorno);
+        if (!item) {
+            Py_DECREF(results);
+            return NULL;
+        }
+        PyList_SET_ITEM(results, i, item);
+    }
+
+    return results;
+}
+
+
+static void
+pyuv__fs_batch_free(fs_batch_ctx *ctx)
+{
+    Py_XDECREF(ctx->ops_obj);
+    Py_XDECREF(ctx->progress);
+    PyMem_Free(ctx->ops);
+    PyMem_Free(ctx->chunks);
+    PyMem_Free(ctx);
+}
+
+
+static void
+pyuv__fs_batch_work_cb(uv_work_t *req)
+{
+    fs_batch_chunk *chunk;
+
+    ASSERT(req);
+    chunk = PYUV_CONTAINER_OF(req, fs_batch_chunk, req);
+    pyuv__fs_batch_run(req->loop, chunk->ctx->ops, chunk->start, chunk->end);
+}
+
+
+static void
+pyuv__fs_batch_done_cb(uv_work_t *req, int status)
+{
+    int gstate = pyuv__gil_ensure(req->loop);
+    Py_ssize_t i;
+    Loop *loop;
+    FSRequest *fs_req;
+    fs_batch_chunk *chunk;
+    fs_batch_ctx *ctx;
+    PyObject *result, *results;
+
+    ASSERT(req);
+    chunk = PYUV_CONTAINER_OF(req, fs_batch_chunk, req);
+    ctx = chunk->ctx;
+    fs_req = ctx->fs_req;
+    loop = REQUEST(fs_req)->loop;
+
+    if (status < 0) {
+        for (i = chunk->start; i < chunk->end; i++) {
+            ctx->ops[i].result = status;
+        }
+    }
+
+    ctx->completed += chunk->end - chunk->start;
+    ctx->chunks_done++;
+
+    if (ctx->progress != Py_None) {
+        result = PyObject_CallFunction(ctx->progress, "nn", ctx->completed, ctx->count);
+        if (result == NULL) {
+            handle_uncaught_exception(loop);
+        }
+        Py_XDECREF(result);
+    }
+
+    if (ctx->chunks_done < ctx->nchunks) {
+        pyuv__gil_release(gstate);
+        return;
+    }
+
+    results = pyuv__fs_batch_results(ctx);
+    if (!results) {
+        PyErr_Clear();
+        PYUV_SET_NONE(results);
+    }
+
+    /* Save result and error in the FSRequest object */
+    PYUV_SET_NONE(fs_req->path);
+    PYUV_SET_NONE(fs_req->error);
+    fs_req->result = results;
+
+    result = PyObject_CallFunctionObjArgs(fs_req->callback, fs_req, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(loop);
+    }
+    Py_XDECREF(result);
+
+    pyuv__fs_batch_free(ctx);
+    Py_DECREF(fs_req);
+
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+FS_func_batch(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    Py_ssize_t i, chunk_size;
+    Loop *loop;
+    FSRequest *fs_req;
+    fs_batch_ctx *ctx;
+    PyObject *ops, *callback, *progress, *ret;
+
+    static char *kwlist[] = {"loop", "ops", "callback", "progress", "chunk_size", NULL};
+
+    UNUSED_ARG(obj);
+    fs_req = NULL;
+    callback = Py_None;
+    progress = Py_None;
+    chunk_size = 256;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O|OOn:batch", kwlist, &LoopType, &loop, &ops, &callback, &progress, &chunk_size)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    if (progress != Py_None && !PyCallable_Check(progress)) {
+        PyErr_SetString(PyExc_TypeError, "a callable or None is required");
+        return NULL;
+    }
+
+    if (chunk_size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "chunk_size must be greater than 0");
+        return NULL;
+    }
+
+    ctx = PyMem_Malloc(sizeof *ctx);
+    if (!ctx) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    memset(ctx, 0, sizeof *ctx);
+
+    ctx->ops_obj = PySequence_Tuple(ops);
+    if (!ctx->ops_obj) {
+        goto error;
+    }
+    ctx->count = PyTuple_GET_SIZE(ctx->ops_obj);
+    Py_INCREF(progress);
+    ctx->progress = progress;
+
+    ctx->ops = PyMem_Malloc(sizeof(fs_batch_op) * (ctx->count > 0 ? ctx->count : 1));
+    if (!ctx->ops) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < ctx->count; i++) {
+        if (pyuv__fs_batch_parse(PyTuple_GET_ITEM(ctx->ops_obj, i), &ctx->ops[i]) != 0) {
+            goto error;
+        }
+    }
+
+    if (callback == Py_None) {
+        Py_BEGIN_ALLOW_THREADS
+        pyuv__fs_batch_run(loop->uv_loop, ctx->ops, 0, ctx->count);
+        Py_END_ALLOW_THREADS
+        ret = pyuv__fs_batch_results(ctx);
+        pyuv__fs_batch_free(ctx);
+        return ret;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        goto error;
+    }
+
+    /* An empty batch still completes through the threadpool, with a single empty chunk */
+    ctx->nchunks = ctx->count > 0 ? (ctx->count + chunk_size - 1) / chunk_size : 1;
+    ctx->chunks = PyMem_Malloc(sizeof(fs_batch_chunk) * ctx->nchunks);
+    if (!ctx->chunks) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    ctx->fs_req = fs_req;
+    for (i = 0; i < ctx->nchunks; i++) {
+        ctx->chunks[i].ctx = ctx;
+        ctx->chunks[i].start = i * chunk_size;
+        ctx->chunks[i].end = (i + 1) * chunk_size < ctx->count ? (i + 1) * chunk_size : ctx->count;
+        err = uv_queue_work(loop->uv_loop, &ctx->chunks[i].req, pyuv__fs_batch_work_cb, pyuv__fs_batch_done_cb);
+        if (err < 0) {
+            /* uv_queue_work only fails on invalid arguments */
+            ASSERT(i == 0);
+            RAISE_UV_EXCEPTION(err, PyExc_FSError);
+            goto error;
+        }
+    }
+
+    Py_INCREF(fs_req);
+    return (PyObject *)fs_req;
+
+error:
+    Py_XDECREF(fs_req);
+    pyuv__fs_batch_free(ctx);
+    return NULL;
+}
+
+
+/*
+ * Recursive directory walk. Every directory is scanned by its own threadpool job, at most
+ * max_parallel of them run at the same time. The entries are delivered to the loop thread one
+ * directory at a time, which is also where new subdirectories get queued.
+ */
+/* Join path and name with the given allocator, an empty path just copies name */
+static char *
+pyuv__fs_walk_join(const char *path, const char *name, void *(*alloc)(size_t))
+{
+    char *r;
+    size_t path_len, name_len;
+    Bool sep;
+
+    path_len = strlen(path);
+    name_len = strlen(name);
+    sep = path_len > 0 && path[path_len - 1] != '/'
+#ifdef PYUV_WINDOWS
+        && path[path_len - 1] != '\\'
+#endif
+        ;
+    r = alloc(path_len + sep + name_len + 1);
+    if (!r) {
+        return NULL;
+    }
+    memcpy(r, path, path_len);
+    if (sep) {
+        r[path_len] = '/';
+    }
+    memcpy(r + path_len + sep, name, name_len + 1);
+    return r;
+}
+
+
+static uv_dirent_type_t
+pyuv__fs_walk_mode_to_type(uint64_t mode)
+{
+    switch (mode & S_IFMT) {
+        case S_IFDIR:
+            return UV_DIRENT_DIR;
+        case S_IFREG:
+            return UV_DIRENT_FILE;
+        case S_IFLNK:
+            return UV_DIRENT_LINK;
+#ifndef PYUV_WINDOWS
+        case S_IFIFO:
+            return UV_DIRENT_FIFO;
+        case S_IFSOCK:
+            return UV_DIRENT_SOCKET;
+        case S_IFCHR:
+            return UV_DIRENT_CHAR;
+        case S_IFBLK:
+            return UV_DIRENT_BLOCK;
+#endif
+        default:
+            return UV_DIRENT_UNKNOWN;
+    }
+}
+
+
+static void
+pyuv__fs_walk_free_job(fs_walk_job *job)
+{
+    size_t i;
+
+    for (i = 0; i < job->nentries; i++) {
+        free(job->entries[i].name);
+    }
+    free(job->entries);
+    PyMem_Free(job->path);
+    PyMem_Free(job);
+}
+
+
+/* Runs without the GIL */
+static void
+pyuv__fs_walk_work_cb(uv_work_t *req)
+{
+    int err, n;
+    char *child;
+    fs_walk_job *job;
+    fs_walk_entry *e;
+    uv_fs_t fs_req, stat_req;
+    uv_dirent_t ent;
+    Bool follow;
+
+    ASSERT(req);
+    job = PYUV_CONTAINER_OF(req, fs_walk_job, req);
+    follow = job->ctx->follow_symlinks;
+
+    if (follow) {
+        /* Used to detect cycles */
+        err = uv_fs_stat(req->loop, &stat_req, job->path, NULL);
+        if (err == 0) {
+            memcpy(&job->dirstat, &stat_req.statbuf, sizeof(uv_stat_t));
+            job->has_dirstat = True;
+        }
+        uv_fs_req_cleanup(&stat_req);
+    }
+
+    n = uv_fs_scandir(req->loop, &fs_req, job->path, 0, NULL);
+    if (n < 0) {
+        job->error = n;
+        uv_fs_req_cleanup(&fs_req);
+        return;
+    }
+
+    job->entries = malloc(sizeof(fs_walk_entry) * (n > 0 ? n : 1));
+    if (!job->entries) {
+        job->error = UV_ENOMEM;
+        uv_fs_req_cleanup(&fs_req);
+        return;
+    }
+
+    while (job->nentries < (size_t)n && uv_fs_scandir_next(&fs_req, &ent) != UV_EOF) {
+        e = &job->entries[job->nentries];
+        e->name = pyuv__fs_walk_join("", ent.name, malloc);
+        if (!e->name) {
+            job->error = UV_ENOMEM;
+            break;
+        }
+        e->type = ent.type;
+        e->has_stat = False;
+        job->nentries++;
+
+        /* Only stat entries when asked to, or when the type can't be known otherwise */
+        if (!job->ctx->stat && ent.type != UV_DIRENT_UNKNOWN && !(follow && ent.type == UV_DIRENT_LINK)) {
+            continue;
+        }
+
+        child = pyuv__fs_walk_join(job->path, ent.name, malloc);
+        if (!child) {
+            job->error = UV_ENOMEM;
+            break;
+        }
+        if (follow) {
+            err = uv_fs_stat(req->loop, &stat_req, child, NULL);
+        } else {
+            err = uv_fs_lstat(req->loop, &stat_req, child, NULL);
+        }
+        if (err == 0) {
+            memcpy(&e->statbuf, &stat_req.statbuf, sizeof(uv_stat_t));
+            e->has_stat = True;
+            if (e->type == UV_DIRENT_UNKNOWN || follow) {
+                e->type = pyuv__fs_walk_mode_to_type(e->statbuf.st_mode);
+            }
+        }
+        uv_fs_req_cleanup(&stat_req);
+        free(child);
+    }
+
+    uv_fs_req_cleanup(&fs_req);
+}
+
+
+static void pyuv__fs_walk_done_cb(uv_work_t *req, int status);
+
+
+static void
+pyuv__fs_walk_dispatch(fs_walk_ctx *ctx)
+{
+    int err;
+    fs_walk_job *job;
+
+    while (ctx->head != NULL && ctx->active < ctx->max_parallel) {
+        job = ctx->head;
+        ctx->head = job->next;
+        if (ctx->head == NULL) {
+            ctx->tail = NULL;
+        }
+        err = uv_queue_work(ctx->loop->uv_loop, &job->req, pyuv__fs_walk_work_cb, pyuv__fs_walk_done_cb);
+        ASSERT(err == 0);
+        UNUSED_ARG(err);
+        ctx->active++;
+    }
+}
+
+
+static int
+pyuv__fs_walk_push(fs_walk_ctx *ctx, char *path)
+{
+    fs_walk_job *job;
+
+    job = PyMem_Malloc(sizeof *job);
+    if (!job) {
+        PyMem_Free(path);
+        PyErr_NoMemory();
+        return -1;
+    }
+    memset(job, 0, sizeof *job);
+    job->ctx = ctx;
+    job->path = path;
+
+    if (ctx->tail) {
+        ctx->tail->next = job;
+    } else {
+        ctx->head = job;
+    }
+    ctx->tail = job;
+    return 0;
+}
+
+
+static PyObject *
+pyuv__fs_walk_entries(fs_walk_job *job)
+{
+    size_t i;
+    fs_walk_entry *e;
+    PyObject *entries, *item, *st;
+    char *path;
+
+    entries = PyList_New(job->nentries);
+    if (!entries) {
+        return NULL;
+    }
+
+    for (i = 0; i < job->nentries; i++) {
+        e = &job->entries[i];
+
+        if (e->type == UV_DIRENT_DIR) {
+            path = pyuv__fs_walk_join(job->path, e->name, PyMem_Malloc);
+            if (!path) {
+                PyErr_NoMemory();
+                goto error;
+            }
+            if (pyuv__fs_walk_push(job->ctx, path) != 0) {
+                goto error;
+            }
+        }
+
+        if (e->has_stat && job->ctx->stat) {
+            st = PyStructSequence_New(&StatResultType);
+            if (!st) {
+                goto error;
+            }
+            stat_to_pyobj(&e->statbuf, st);
+        } else {
+            PYUV_SET_NONE(st);
+        }
+
+        item = PyStructSequence_New(&WalkEntryType);
+        if (!item) {
+            Py_DECREF(st);
+            goto error;
+        }
+        PyStructSequence_SET_ITEM(item, 0, Py_BuildValue("s", e->name));
+        PyStructSequence_SET_ITEM(item, 1, PyInt_FromLong((long)e->type));
+        PyStructSequence_SET_ITEM(item, 2, st);
+        PyList_SET_ITEM(entries, i, item);
+    }
+
+    return entries;
+
+error:
+    Py_DECREF(entries);
+    return NULL;
+}
+
+
+static void
+pyuv__fs_walk_done_cb(uv_work_t *req, int status)
+{
+    int gstate = pyuv__gil_ensure(req->loop);
+    int r;
+    fs_walk_job *job;
+    fs_walk_ctx *ctx;
+    PyObject *result, *entries, *errorno, *key;
+
+    ASSERT(req);
+    job = PYUV_CONTAINER_OF(req, fs_walk_job, req);
+    ctx = job->ctx;
+    ctx->active--;
+
+    if (status < 0) {
+        job->error = status;
+    }
+
+    /* Skip directories which were already visited through a symlink */
+    if (job->error == 0 && job->has_dirstat && ctx->visited) {
+        key = Py_BuildValue("KK", (unsigned PY_LONG_LONG)job->dirstat.st_dev, (unsigned PY_LONG_LONG)job->dirstat.st_ino);
+        r = key ? PySet_Contains(ctx->visited, key) : -1;
+        if (r == 0) {
+            r = PySet_Add(ctx->visited, key);
+        }
+        Py_XDECREF(key);
+        if (r < 0) {
+            PyErr_Clear();
+        } else if (r == 1) {
+            goto done;
+        }
+    }
+
+    if (job->error == 0) {
+        entries = pyuv__fs_walk_entries(job);
+        if (!entries) {
+            handle_uncaught_exception(ctx->loop);
+            goto done;
+        }
+        PYUV_SET_NONE(errorno);
+    } else {
+        PYUV_SET_NONE(entries);
+        errorno = PyInt_FromLong((long)job->error);
+    }
+
+    result = PyObject_CallFunction(ctx->callback, "sOO", job->path, entries, errorno);
+    if (result == NULL) {
+        handle_uncaught_exception(ctx->loop);
+    }
+    Py_XDECREF(result);
+    Py_DECREF(entries);
+    Py_XDECREF(errorno);
+
+done:
+    pyuv__fs_walk_free_job(job);
+    pyuv__fs_walk_dispatch(ctx);
+
+    if (ctx->active == 0) {
+        ASSERT(ctx->head == NULL);
+        result = PyObject_CallFunctionObjArgs(ctx->callback, Py_None, Py_None, Py_None, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(ctx->loop);
+        }
+        Py_XDECREF(result);
+        Py_DECREF(ctx->loop);
+        Py_DECREF(ctx->callback);
+        Py_XDECREF(ctx->visited);
+        PyMem_Free(ctx);
+    }
+
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+FS_func_walk(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int do_stat, follow_symlinks, max_parallel;
+    char *root, *path;
+    Loop *loop;
+    fs_walk_ctx *ctx;
+    PyObject *callback;
+
+    static char *kwlist[] = {"loop", "root", "callback", "stat", "follow_symlinks", "max_parallel", NULL};
+
+    UNUSED_ARG(obj);
+    do_stat = 0;
+    follow_symlinks = 0;
+    max_parallel = 4;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!sO|iii:walk", kwlist, &LoopType, &loop, &root, &callback, &do_stat, &follow_symlinks, &max_parallel)) {
+        return NULL;
+    }
+
+    if (!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    if (max_parallel < 1) {
+        PyErr_SetString(PyExc_ValueError, "max_parallel must be greater than 0");
+        return NULL;
+    }
+
+    ctx = PyMem_Malloc(sizeof *ctx);
+    if (!ctx) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    memset(ctx, 0, sizeof *ctx);
+
+    if (follow_symlinks) {
+        ctx->visited = PySet_New(NULL);
+        if (!ctx->visited) {
+            PyMem_Free(ctx);
+            return NULL;
+        }
+    }
+
+    path = pyuv__fs_walk_join("", root, PyMem_Malloc);
+    if (!path) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    if (pyuv__fs_walk_push(ctx, path) != 0) {
+        goto error;
+    }
+
+    Py_INCREF(loop);
+    Py_INCREF(callback);
+    ctx->loop = loop;
+    ctx->callback = callback;
+    ctx->stat = do_stat ? True : False;
+    ctx->follow_symlinks = follow_symlinks ? True : False;
+    ctx->max_parallel = max_parallel;
+
+    pyuv__fs_walk_dispatch(ctx);
+
+    Py_RETURN_NONE;
+
+error:
+    Py_XDECREF(ctx->visited);
+    PyMem_Free(ctx);
+    return NULL;
+}
+
+
+static PyObject *
+FS_func_fsync(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    long fd;
+    Loop *loop;
+    FSRequest *fs_req;
+    PyObject *callback, *ret;
+
+    static char *kwlist[] = {"loop", "fd", "callback", NULL};
+
+    UNUSED_ARG(obj);
+    fs_req = NULL;
+    callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!l|O:fsync", kwlist, &LoopType, &loop, &fd, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_FSYNC, (uv_file)fd, NULL, 0, 0, NULL, 0, 0) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_fsync, loop->uv_loop, &fs_req->req, (uv_file)fd);
+    }
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    Py_INCREF(fs_req);
+    if (callback != Py_None) {
+        /* No need to cleanup, it will be done in the callback */
+        return (PyObject *)fs_req;
+    } else {
+        pyuv__process_fs_req(&fs_req->req);
+        Py_INCREF(fs_req->result);
+        ret = fs_req->result;
+        Py_DECREF(fs_req);
+        return ret;
+    }
+}
+
+
+static PyObject *
+FS_func_fdatasync(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    long fd;
+    Loop *loop;
+    FSRequest *fs_req;
+    PyObject *callback, *ret;
+
+    static char *kwlist[] = {"loop", "fd", "callback", NULL};
+
+    UNUSED_ARG(obj);
+    fs_req = NULL;
+    callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!l|O:fdatasync", kwlist, &LoopType, &loop, &fd, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    if (callback != Py_None && pyuv__uring_submit(loop, fs_req, UV_FS_FDATASYNC, (uv_file)fd, NULL, 0, 0, NULL, 0, 0) == 0) {
+        err = 0;
+    } else {
+        PYUV_FS_RUN(err, callback, uv_fs_fdatasync, loop->uv_loop, &fs_req->req, (uv_file)fd);
+    }
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    Py_INCREF(fs_req);
+    if (callback != Py_None) {
+        /* No need to cleanup, it will be done in the callback */
+        return (PyObject *)fs_req;
+    } else {
+        pyuv__process_fs_req(&fs_req->req);
+        Py_INCREF(fs_req->result);
+        ret = fs_req->result;
+        Py_DECREF(fs_req);
+        return ret;
+    }
+}
+
+
+static PyObject *
+FS_func_ftruncate(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    int64_t offset;
+    long fd;
+    Loop *loop;
+    FSRequest *fs_req;
+    PyObject *callback, *ret;
+
+    static char *kwlist[] = {"loop", "fd", "offset", "callback", NULL};
+
+    UNUSED_ARG(obj);
+    fs_req = NULL;
+    callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!lL|O:ftruncate", kwlist, &LoopType, &loop, &fd, &offset, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    PYUV_FS_RUN(err, callback, uv_fs_ftruncate, loop->uv_loop, &fs_req->req, (uv_file)fd, offset);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    Py_INCREF(fs_req);
+    if (callback != Py_None) {
+        /* No need to cleanup, it will be done in the callback */
+        return (PyObject *)fs_req;
+    } else {
+        pyuv__process_fs_req(&fs_req->req);
+        Py_INCREF(fs_req->result);
+        ret = fs_req->result;
+        Py_DECREF(fs_req);
+        return ret;
+    }
+}
+
+
+/*
+ * Chunked scandir. The directory is read incrementally by successive threadpool jobs, each one
+ * reading up to chunk_size entries. The next job is only queued after the previous chunk was
+ * delivered, so memory use is bounded by the chunk size.
+ */
+#ifndef PYUV_WINDOWS
+static uv_dirent_type_t
+pyuv__fs_scandir_dtype(struct dirent *d)
+{
+#ifdef DT_UNKNOWN
+    switch (d->d_type) {
+        case DT_DIR:
+            return UV_DIRENT_DIR;
+        case DT_REG:
+            return UV_DIRENT_FILE;
+        case DT_LNK:
+            return UV_DIRENT_LINK;
+        case DT_FIFO:
+            return UV_DIRENT_FIFO;
+        case DT_SOCK:
+            return UV_DIRENT_SOCKET;
+        case DT_CHR:
+            return UV_DIRENT_CHAR;
+        case DT_BLK:
+            return UV_DIRENT_BLOCK;
+        default:
+            return UV_DIRENT_UNKNOWN;
+    }
+#else
+    UNUSED_ARG(d);
+    return UV_DIRENT_UNKNOWN;
+#endif
+}
+#endif
+
+
+static int
+pyuv__fs_scandir_add(fs_scandir_ctx *ctx, const char *name, uv_dirent_type_t type)
+{
+    size_t len;
+    char *copy;
+
+    len = strlen(name) + 1;
+    copy = malloc(len);
+    if (!copy) {
+        return UV_ENOMEM;
+    }
+    memcpy(copy, name, len);
+    ctx->entries[ctx->nentries].name = copy;
+    ctx->entries[ctx->nentries].type = type;
+    ctx->nentries++;
+    return 0;
+}
+
+
+/* Runs without the GIL */
+static void
+pyuv__fs_scandir_work_cb(uv_work_t *req)
+{
+    fs_scandir_ctx *ctx;
+#ifdef PYUV_WINDOWS
+    int err;
+    uv_dirent_t ent;
+#else
+    struct dirent *d;
+#endif
+
+    ASSERT(req);
+    ctx = PYUV_CONTAINER_OF(req, fs_scandir_ctx, req);
+    ASSERT(ctx->nentries == 0);
+
+#ifdef PYUV_WINDOWS
+    /* There is no incremental directory reading in libuv, read the listing once and hand it
+     * out in chunks */
+    if (!ctx->opened) {
+        err = uv_fs_scandir(req->loop, &ctx->scandir_req, ctx->path, 0, NULL);
+        ctx->opened = True;
+        if (err < 0) {
+            ctx->error = err;
+            return;
+        }
+    }
+    while (ctx->nentries < ctx->chunk_size) {
+        if (uv_fs_scandir_next(&ctx->scandir_req, &ent) == UV_EOF) {
+            ctx->eof = True;
+            break;
+        }
+        ctx->error = pyuv__fs_scandir_add(ctx, ent.name, ent.type);
+        if (ctx->error < 0) {
+            break;
+        }
+    }
+#else
+    if (ctx->dir == NULL) {
+        ctx->dir = opendir(ctx->path);
+        if (ctx->dir == NULL) {
+            ctx->error = -errno;
+            return;
+        }
+    }
+    while (ctx->nentries < ctx->chunk_size) {
+        errno = 0;
+        d = readdir(ctx->dir);
+        if (d == NULL) {
+            if (errno != 0) {
+                ctx->error = -errno;
+            } else {
+                ctx->eof = True;
+            }
+            break;
+        }
+        if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0) {
+            continue;
+        }
+        ctx->error = pyuv__fs_scandir_add(ctx, d->d_name, pyuv__fs_scandir_dtype(d));
+        if (ctx->error < 0) {
+            break;
+        }
+    }
+#endif
+}
+
+
+static void
+pyuv__fs_scandir_free(fs_scandir_ctx *ctx)
+{
+    size_t i;
+
+#ifdef PYUV_WINDOWS
+    if (ctx->opened) {
+        uv_fs_req_cleanup(&ctx->scandir_req);
+    }
+#else
+    if (ctx->dir != NULL) {
+        closedir(ctx->dir);
+    }
+#endif
+    for (i = 0; i < ctx->nentries; i++) {
+        free(ctx->entries[i].name);
+    }
+    PyMem_Free(ctx->entries);
+    PyMem_Free(ctx->path);
+    PyMem_Free(ctx);
+}
+
+
+static void
+pyuv__fs_scandir_deliver(fs_scandir_ctx *ctx, PyObject *r, PyObject *errorno)
+{
+    FSRequest *fs_req;
+    PyObject *result, *path;
+
+    fs_req = ctx->fs_req;
+
+    path = Py_BuildValue("s", ctx->path);
+    if (!path) {
+        PyErr_Clear();
+        PYUV_SET_NONE(path);
+    }
+
+    /* The request is delivered several times, drop the previous values */
+    Py_XDECREF(fs_req->path);
+    Py_XDECREF(fs_req->result);
+    Py_XDECREF(fs_req->error);
+    fs_req->path = path;
+    fs_req->result = r;
+    fs_req->error = errorno;
+
+    result = PyObject_CallFunctionObjArgs(fs_req->callback, fs_req, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(REQUEST(fs_req)->loop);
+    }
+    Py_XDECREF(result);
+}
+
+
+static void
+pyuv__fs_scandir_done_cb(uv_work_t *req, int status)
+{
+    int gstate = pyuv__gil_ensure(req->loop);
+    int err;
+    size_t i;
+    fs_scandir_ctx *ctx;
+    FSRequest *fs_req;
+    PyObject *r, *errorno, *item;
+
+    ASSERT(req);
+    ctx = PYUV_CONTAINER_OF(req, fs_scandir_ctx, req);
+    fs_req = ctx->fs_req;
+
+    if (status < 0) {
+        ctx->error = status;
+    }
+
+    if (ctx->error < 0) {
+        PYUV_SET_NONE(r);
+        errorno = PyInt_FromLong((long)ctx->error);
+    } else {
+        PYUV_SET_NONE(errorno);
+        r = PyList_New(0);
+        for (i = 0; r != NULL && i < ctx->nentries; i++) {
+            item = PyStructSequence_New(&DirEntType);
+            if (!item) {
+                break;
+            }
+            PyStructSequence_SET_ITEM(item, 0, Py_BuildValue("s", ctx->entries[i].name));
+            PyStructSequence_SET_ITEM(item, 1, PyInt_FromLong((long)ctx->entries[i].type));
+            PyList_Append(r, item);
+            Py_DECREF(item);
+        }
+        if (!r) {
+            PyErr_Clear();
+            PYUV_SET_NONE(r);
+        }
+    }
+
+    for (i = 0; i < ctx->nentries; i++) {
+        free(ctx->entries[i].name);
+    }
+
+    /* The end is signaled with an empty list, which is already the case if the directory
+     * was exhausted exactly at the end of the previous chunk */
+    if (ctx->eof && ctx->error == 0 && ctx->nentries > 0) {
+        ctx->nentries = 0;
+        pyuv__fs_scandir_deliver(ctx, r, errorno);
+        r = PyList_New(0);
+        if (!r) {
+            PyErr_Clear();
+            PYUV_SET_NONE(r);
+        }
+        PYUV_SET_NONE(errorno);
+    }
+    ctx->nentries = 0;
+    pyuv__fs_scandir_deliver(ctx, r, errorno);
+
+    if (ctx->eof || ctx->error < 0) {
+        goto end;
+    }
+
+    err = uv_queue_work(req->loop, &ctx->req, pyuv__fs_scandir_work_cb, pyuv__fs_scandir_done_cb);
+    if (err < 0) {
+        ctx->error = err;
+        Py_INCREF(Py_None);
+        pyuv__fs_scandir_deliver(ctx, Py_None, PyInt_FromLong((long)err));
+        goto end;
+    }
+
+    pyuv__gil_release(gstate);
+    return;
+
+end:
+    UV_REQUEST(fs_req) = NULL;
+    pyuv__fs_scandir_free(ctx);
+    Py_DECREF(fs_req);
+
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+pyuv__fs_scandir_chunked(Loop *loop, FSRequest *fs_req, const char *path, Py_ssize_t chunk_size)
+{
+    int err;
+    size_t path_len;
+    fs_scandir_ctx *ctx;
+
+    ctx = PyMem_Malloc(sizeof *ctx);
+    if (!ctx) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    memset(ctx, 0, sizeof *ctx);
+
+    path_len = strlen(path) + 1;
+    ctx->path = PyMem_Malloc(path_len);
+    ctx->entries = PyMem_Malloc(sizeof(fs_scandir_entry) * chunk_size);
+    if (!ctx->path || !ctx->entries) {
+        PyErr_NoMemory();
+        pyuv__fs_scandir_free(ctx);
+        return NULL;
+    }
+    memcpy(ctx->path, path, path_len);
+    ctx->chunk_size = (size_t)chunk_size;
+    ctx->fs_req = fs_req;
+
+    err = uv_queue_work(loop->uv_loop, &ctx->req, pyuv__fs_scandir_work_cb, pyuv__fs_scandir_done_cb);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        pyuv__fs_scandir_free(ctx);
+        return NULL;
+    }
+
+    UV_REQUEST(fs_req) = (uv_req_t *)&ctx->req;
+    Py_INCREF(fs_req);
+    return (PyObject *)fs_req;
+}
+
+
+static PyObject *
+FS_func_scandir(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    char *path;
+    Loop *loop;
+    FSRequest *fs_req;
+    Py_ssize_t chunk_size;
+    PyObject *callback, *ret;
+
+    static char *kwlist[] = {"loop", "path", "callback", "chunk_size", NULL};
+
+    UNUSED_ARG(obj);
+    fs_req = NULL;
+    callback = Py_None;
+    chunk_size = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!s|On:scandir", kwlist, &LoopType, &loop, &path, &callback, &chunk_size)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    if (chunk_size < 0 || (chunk_size > 0 && callback == Py_None)) {
+        PyErr_SetString(PyExc_ValueError, "chunk_size must be a positive number and requires a callback");
+        return NULL;
+    }
+
+    if (chunk_size > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(fs_scandir_entry)) {
+        PyErr_SetString(PyExc_ValueError, "chunk_size is too large");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    if (chunk_size > 0) {
+        ret = pyuv__fs_scandir_chunked(loop, fs_req, path, chunk_size);
+        if (!ret) {
+            Py_DECREF(fs_req);
+        }
+        return ret;
+    }
+
+    PYUV_FS_RUN(err, callback, uv_fs_scandir, loop->uv_loop, &fs_req->req, path, 0);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    Py_INCREF(fs_req);
+    if (callback != Py_None) {
+        /* No need to cleanup, it will be done in the callback */
+        return (PyObject *)fs_req;
+    } else {
+        pyuv__process_fs_req(&fs_req->req);
+        Py_INCREF(fs_req->result);
+        ret = fs_req->result;
+        Py_DECREF(fs_req);
+        return ret;
+    }
+}
+
+
+/*
+ * sendfile with progress reporting. The transfer is split in chunks of PYUV_SENDFILE_CHUNK bytes,
+ * each one a threadpool job, and the progress callback is called on the loop thread after each.
+ */
+static void
+pyuv__fs_sendfile_work_cb(uv_work_t *req)
+{
+    fs_sendfile_ctx *ctx;
+    uv_fs_t fs_req;
+    uint64_t chunk, done;
+    int r;
+
+    ASSERT(req);
+    ctx = PYUV_CONTAINER_OF(req, fs_sendfile_ctx, req);
+
+    chunk = ctx->length - ctx->sent;
+    if (chunk > PYUV_SENDFILE_CHUNK) {
+        chunk = PYUV_SENDFILE_CHUNK;
+    }
+
+    /* errors after a partial transfer show up on the next chunk */
+    done = 0;
+    r = 0;
+    while (done < chunk) {
+        r = uv_fs_sendfile(req->loop, &fs_req, ctx->out_fd, ctx->in_fd, ctx->offset + (int64_t)(ctx->sent + done), (size_t)(chunk - done), NULL);
+        uv_fs_req_cleanup(&fs_req);
+        if (r <= 0) {
+            break;
+        }
+        done += r;
+    }
+
+    ctx->result = (r < 0 && done == 0) ? r : (int64_t)done;
+}
+
+
+static void
+pyuv__fs_sendfile_done_cb(uv_work_t *req, int status)
+{
+    int err, gstate;
+    Loop *loop;
+    FSRequest *fs_req;
+    fs_sendfile_ctx *ctx;
+    PyObject *result;
+
+    ASSERT(req);
+    ctx = PYUV_CONTAINER_OF(req, fs_sendfile_ctx, req);
+    fs_req = ctx->fs_req;
+    loop = REQUEST(fs_req)->loop;
+    gstate = pyuv__gil_ensure(loop->uv_loop);
+
+    if (status == UV_ECANCELED) {
+        ctx->result = status;
+    }
+
+    if (ctx->result > 0) {
+        ctx->sent += ctx->result;
+
+        result = PyObject_CallFunction(ctx->progress, "KK", (unsigned PY_LONG_LONG)ctx->sent, (unsigned PY_LONG_LONG)ctx->length);
+        if (result == NULL) {
+            handle_uncaught_exception(loop);
+        }
+        Py_XDECREF(result);
+
+        if (ctx->sent < ctx->length) {
+            err = uv_queue_work(loop->uv_loop, &ctx->req, pyuv__fs_sendfile_work_cb, pyuv__fs_sendfile_done_cb);
+            if (err == 0) {
+                pyuv__gil_release(gstate);
+                return;
+            }
+            ctx->result = err;
+        }
+    }
+
+    /* Save result and error in the FSRequest object */
+    PYUV_SET_NONE(fs_req->path);
+    if (ctx->result < 0) {
+        fs_req->error = PyInt_FromLong((long)ctx->result);
+        PYUV_SET_NONE(fs_req->result);
+    } else {
+        PYUV_SET_NONE(fs_req->error);
+        fs_req->result = PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)ctx->sent);
+        if (!fs_req->result) {
+            PyErr_Clear();
+            PYUV_SET_NONE(fs_req->result);
+        }
+    }
+
+    result = PyObject_CallFunctionObjArgs(fs_req->callback, fs_req, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(loop);
+    }
+    Py_XDECREF(result);
+
+    UV_REQUEST(fs_req) = NULL;
+    Py_DECREF(ctx->progress);
+    PyMem_Free(ctx);
+    Py_DECREF(fs_req);
+
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+FS_func_sendfile(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    int64_t in_offset;
+    PY_LONG_LONG length;
+    long out_fd, in_fd;
+    Loop *loop;
+    FSRequest *fs_req;
+    fs_sendfile_ctx *ctx;
+    PyObject *callback, *progress, *ret;
+
+    static char *kwlist[] = {"loop", "out_fd", "in_fd", "in_offset", "length", "callback", "progress", NULL};
+
+    UNUSED_ARG(obj);
+    fs_req = NULL;
+    callback = Py_None;
+    progress = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!llLL|OO:sendfile", kwlist, &LoopType, &loop, &out_fd, &in_fd, &in_offset, &length, &callback, &progress)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    if (progress != Py_None && !PyCallable_Check(progress)) {
+        PyErr_SetString(PyExc_TypeError, "a callable or None is required");
+        return NULL;
+    }
+
+    if (progress != Py_None && callback == Py_None) {
+        PyErr_SetString(PyExc_ValueError, "progress can only be used with a callback");
+        return NULL;
+    }
+
+    if (length < 0) {
+        PyErr_SetString(PyExc_ValueError, "length must be a non-negative integer");
+        return NULL;
+    }
+
+    fs_req = (FSRequest *)PyObject_CallFunctionObjArgs((PyObject *)&FSRequestType, loop, callback, NULL);
+    if (!fs_req) {
+        return NULL;
+    }
+
+    if (progress != Py_None) {
+        ctx = PyMem_Malloc(sizeof *ctx);
+        if (!ctx) {
+            Py_DECREF(fs_req);
+            return PyErr_NoMemory();
+        }
+        ctx->fs_req = fs_req;
+        ctx->out_fd = (uv_file)out_fd;
+        ctx->in_fd = (uv_file)in_fd;
+        ctx->offset = in_offset;
+        ctx->length = (uint64_t)length;
+        ctx->sent = 0;
+        ctx->result = 0;
+        UV_REQUEST(fs_req) = (uv_req_t *)&ctx->req;
+        err = uv_queue_work(loop->uv_loop, &ctx->req, pyuv__fs_sendfile_work_cb, pyuv__fs_sendfile_done_cb);
+        if (err < 0) {
+            UV_REQUEST(fs_req) = NULL;
+            PyMem_Free(ctx);
+            RAISE_UV_EXCEPTION(err, PyExc_FSError);
+            Py_DECREF(fs_req);
+            return NULL;
+        }
+        Py_INCREF(progress);
+        ctx->progress = progress;
+        /* No need to cleanup, it will be done in the callback */
+        Py_INCREF(fs_req);
+        return (PyObject *)fs_req;
+    }
+
+    /* A single call may transfer less than requested, the result tells how much was sent */
+    if ((unsigned PY_LONG_LONG)length > (unsigned PY_LONG_LONG)PY_SSIZE_T_MAX) {
+        length = PY_SSIZE_T_MAX;
+    }
+
+    PYUV_FS_RUN(err, callback, uv_fs_sendfile, loop->uv_loop, &fs_req->req, (uv_file)out_fd, (uv_file)in_fd, in_offset, (size_t)length);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    Py_INCREF(fs_req);
+    if (callback != Py_None) {
+        /* No need to cleanup, it will be done in the callback */
+        return (PyObject *)fs_req;
+    } else {
+        pyuv__process_fs_req(&fs_req->req);
+        Py_INCREF(fs_req->result);
+        ret = fs_req->result;
+        Py_DECREF(fs_req);
+        return ret;
+    }
+}
+
+
+static PyObject *
 FS_func_utime(PyObject *obj, PyObject *args, PyObject *kwargs)
 {
     int err;
@@ -1362,7 +3641,7 @@ FS_func_utime(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_utime(loop->uv_loop, &fs_req->req, path, atime, mtime, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_utime, loop->uv_loop, &fs_req->req, path, atime, mtime);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -1413,7 +3692,7 @@ FS_func_futime(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_futime(loop->uv_loop, &fs_req->req, (uv_file)fd, atime, mtime, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_futime, loop->uv_loop, &fs_req->req, (uv_file)fd, atime, mtime);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -1463,7 +3742,7 @@ FS_func_access(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_access(loop->uv_loop, &fs_req->req, path, flags, (callback != Py_None) ? pyuv__process_fs_req : NULL);
+    PYUV_FS_RUN(err, callback, uv_fs_access, loop->uv_loop, &fs_req->req, path, flags);
     if (err < 0) {
         RAISE_UV_EXCEPTION(err, PyExc_FSError);
         Py_DECREF(fs_req);
@@ -1513,24 +3792,434 @@ FS_func_realpath(PyObject *obj, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    err = uv_fs_realpath(loop->uv_loop, &fs_req->req, path, (callback != Py_None) ? pyuv__process_fs_req : NULL);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_FSError);
-        Py_DECREF(fs_req);
+    PYUV_FS_RUN(err, callback, uv_fs_realpath, loop->uv_loop, &fs_req->req, path);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        Py_DECREF(fs_req);
+        return NULL;
+    }
+
+    Py_INCREF(fs_req);
+    if (callback != Py_None) {
+        /* No need to cleanup, it will be done in the callback */
+        return (PyObject *)fs_req;
+    } else {
+        pyuv__process_fs_req(&fs_req->req);
+        Py_INCREF(fs_req->result);
+        ret = fs_req->result;
+        Py_DECREF(fs_req);
+        return ret;
+    }
+}
+
+
+/* MMap */
+
+static size_t
+pyuv__fs_page_size(void)
+{
+#ifdef PYUV_WINDOWS
+    return 4096;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+
+/*
+ * Runs in the threadpool (or with the GIL released). For MADV_WILLNEED the pages are also
+ * touched, so they are resident by the time the loop thread gets to them.
+ */
+static int
+pyuv__fs_mmap_advise(char *addr, size_t len, int advice)
+{
+#ifdef PYUV_WINDOWS
+    UNUSED_ARG(addr);
+    UNUSED_ARG(len);
+    UNUSED_ARG(advice);
+    return UV_ENOSYS;
+#else
+    size_t page, i;
+    volatile char sink;
+
+    if (madvise(addr, len, advice) != 0) {
+        return -errno;
+    }
+
+    if (advice == MADV_WILLNEED) {
+        page = pyuv__fs_page_size();
+        for (i = 0; i < len; i += page) {
+            sink = addr[i];
+        }
+        (void)sink;
+    }
+
+    return 0;
+#endif
+}
+
+
+static void
+pyuv__fs_mmap_advise_work_cb(uv_work_t *req)
+{
+    fs_mmap_advise_ctx *ctx;
+
+    ASSERT(req);
+    ctx = PYUV_CONTAINER_OF(req, fs_mmap_advise_ctx, req);
+    ctx->result = pyuv__fs_mmap_advise(ctx->addr, ctx->len, ctx->advice);
+}
+
+
+static void
+pyuv__fs_mmap_advise_done_cb(uv_work_t *req, int status)
+{
+    fs_mmap_advise_ctx *ctx;
+    MMap *self;
+    PyObject *result, *errorno;
+    int err, gstate;
+
+    ASSERT(req);
+    ctx = PYUV_CONTAINER_OF(req, fs_mmap_advise_ctx, req);
+    self = ctx->mmap;
+    gstate = pyuv__gil_ensure(self->loop->uv_loop);
+
+    err = status == UV_ECANCELED ? status : ctx->result;
+    if (err < 0) {
+        errorno = PyInt_FromLong((long)err);
+    } else {
+        Py_INCREF(Py_None);
+        errorno = Py_None;
+    }
+
+    /* the mapping can be closed again */
+    self->exports--;
+
+    result = PyObject_CallFunctionObjArgs(ctx->callback, self, errorno, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(self->loop);
+    }
+    Py_XDECREF(result);
+    Py_XDECREF(errorno);
+
+    Py_DECREF(ctx->callback);
+    Py_DECREF(self);
+    PyMem_Free(ctx);
+
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+MMap_func_advise(MMap *self, PyObject *args, PyObject *kwargs)
+{
+    int err, advice;
+    char *addr;
+    size_t page, delta;
+    Py_ssize_t offset, length;
+    fs_mmap_advise_ctx *ctx;
+    PyObject *callback;
+
+    static char *kwlist[] = {"advice", "offset", "length", "callback", NULL};
+
+    if (self->map == NULL) {
+        PyErr_SetString(PyExc_ValueError, "mmap is closed");
+        return NULL;
+    }
+
+    offset = 0;
+    length = -1;
+    callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|nnO:advise", kwlist, &advice, &offset, &length, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable or None is required");
+        return NULL;
+    }
+
+    if (offset < 0 || offset > self->len) {
+        PyErr_SetString(PyExc_ValueError, "offset is out of range");
+        return NULL;
+    }
+
+    if (length < 0 || length > self->len - offset) {
+        length = self->len - offset;
+    }
+
+    /* madvise wants a page aligned address */
+    page = pyuv__fs_page_size();
+    addr = self->base + offset;
+    delta = (size_t)(addr - self->map) % page;
+    addr -= delta;
+
+    if (callback == Py_None) {
+        /* Another thread could try to close the mapping while the GIL is released */
+        self->exports++;
+        Py_BEGIN_ALLOW_THREADS
+        err = pyuv__fs_mmap_advise(addr, (size_t)length + delta, advice);
+        Py_END_ALLOW_THREADS
+        self->exports--;
+        if (err < 0) {
+            RAISE_UV_EXCEPTION(err, PyExc_FSError);
+            return NULL;
+        }
+        Py_RETURN_NONE;
+    }
+
+    ctx = PyMem_Malloc(sizeof *ctx);
+    if (!ctx) {
+        return PyErr_NoMemory();
+    }
+
+    ctx->mmap = self;
+    ctx->callback = callback;
+    ctx->addr = addr;
+    ctx->len = (size_t)length + delta;
+    ctx->advice = advice;
+    ctx->result = 0;
+
+    err = uv_queue_work(self->loop->uv_loop, &ctx->req, pyuv__fs_mmap_advise_work_cb, pyuv__fs_mmap_advise_done_cb);
+    if (err < 0) {
+        PyMem_Free(ctx);
+        RAISE_UV_EXCEPTION(err, PyExc_FSError);
+        return NULL;
+    }
+
+    /* The mapping must not go away while the threadpool is using it */
+    self->exports++;
+    Py_INCREF(self);
+    Py_INCREF(callback);
+
+    Py_RETURN_NONE;
+}
+
+
+static void
+pyuv__fs_mmap_unmap(MMap *self)
+{
+    if (self->map != NULL) {
+#ifndef PYUV_WINDOWS
+        munmap(self->map, self->map_len);
+#endif
+        self->map = NULL;
+        self->base = NULL;
+        self->len = 0;
+    }
+}
+
+
+static PyObject *
+MMap_func_close(MMap *self)
+{
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot close mmap while it's in use");
+        return NULL;
+    }
+
+    pyuv__fs_mmap_unmap(self);
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+MMap_closed_get(MMap *self, void *closure)
+{
+    UNUSED_ARG(closure);
+
+    return PyBool_FromLong((long)(self->map == NULL));
+}
+
+
+static Py_ssize_t
+MMap_sq_length(MMap *self)
+{
+    return self->len;
+}
+
+
+static int
+MMap_tp_getbuffer(MMap *self, Py_buffer *view, int flags)
+{
+    if (self->map == NULL) {
+        PyErr_SetString(PyExc_ValueError, "mmap is closed");
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->base, self->len, 1, flags) < 0) {
+        return -1;
+    }
+    self->exports++;
+    return 0;
+}
+
+
+static void
+MMap_tp_releasebuffer(MMap *self, Py_buffer *view)
+{
+    UNUSED_ARG(view);
+
+    self->exports--;
+}
+
+
+static void
+MMap_tp_dealloc(MMap *self)
+{
+    pyuv__fs_mmap_unmap(self);
+    Py_XDECREF(self->loop);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+static PyMethodDef
+MMap_tp_methods[] = {
+    { "advise", (PyCFunction)MMap_func_advise, METH_VARARGS | METH_KEYWORDS, "Give advice about the use of the mapped memory." },
+    { "close", (PyCFunction)MMap_func_close, METH_NOARGS, "Unmap the memory." },
+    { NULL }
+};
+
+
+static PyGetSetDef MMap_tp_getsets[] = {
+    {"closed", (getter)MMap_closed_get, NULL, "Indicates if the mapping was closed.", NULL},
+    {NULL}
+};
+
+
+static PySequenceMethods MMap_tp_as_sequence = {
+    (lenfunc)MMap_sq_length,                                       /*sq_length*/
+};
+
+
+static PyBufferProcs MMap_tp_as_buffer = {
+#ifndef PYUV_PYTHON3
+    0,                                                             /*bf_getreadbuffer*/
+    0,                                                             /*bf_getwritebuffer*/
+    0,                                                             /*bf_getsegcount*/
+    0,                                                             /*bf_getcharbuffer*/
+#endif
+    (getbufferproc)MMap_tp_getbuffer,                              /*bf_getbuffer*/
+    (releasebufferproc)MMap_tp_releasebuffer,                      /*bf_releasebuffer*/
+};
+
+
+static PyTypeObject MMapType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyuv._cpyuv.fs.MMap",                                         /*tp_name*/
+    sizeof(MMap),                                                  /*tp_basicsize*/
+    0,                                                             /*tp_itemsize*/
+    (destructor)MMap_tp_dealloc,                                   /*tp_dealloc*/
+    0,                                                             /*tp_print*/
+    0,                                                             /*tp_getattr*/
+    0,                                                             /*tp_setattr*/
+    0,                                                             /*tp_compare*/
+    0,                                                             /*tp_repr*/
+    0,                                                             /*tp_as_number*/
+    &MMap_tp_as_sequence,                                          /*tp_as_sequence*/
+    0,                                                             /*tp_as_mapping*/
+    0,                                                             /*tp_hash */
+    0,                                                             /*tp_call*/
+    0,                                                             /*tp_str*/
+    0,                                                             /*tp_getattro*/
+    0,                                                             /*tp_setattro*/
+    &MMap_tp_as_buffer,                                            /*tp_as_buffer*/
+#ifdef PYUV_PYTHON3
+    Py_TPFLAGS_DEFAULT,                                            /*tp_flags*/
+#else
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER,                /*tp_flags*/
+#endif
+    0,                                                             /*tp_doc*/
+    0,                                                             /*tp_traverse*/
+    0,                                                             /*tp_clear*/
+    0,                                                             /*tp_richcompare*/
+    0,                                                             /*tp_weaklistoffset*/
+    0,                                                             /*tp_iter*/
+    0,                                                             /*tp_iternext*/
+    MMap_tp_methods,                                               /*tp_methods*/
+    0,                                                             /*tp_members*/
+    MMap_tp_getsets,                                               /*tp_getsets*/
+};
+
+
+static PyObject *
+FS_func_mmap(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    int fd;
+    Py_ssize_t length;
+    PY_LONG_LONG offset;
+    Loop *loop;
+    MMap *self;
+#ifndef PYUV_WINDOWS
+    char *map;
+    size_t delta, map_len;
+    struct stat st;
+#endif
+
+    static char *kwlist[] = {"loop", "fd", "length", "offset", NULL};
+
+    UNUSED_ARG(obj);
+    offset = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!in|L:mmap", kwlist, &LoopType, &loop, &fd, &length, &offset)) {
+        return NULL;
+    }
+
+    if (length < 0 || offset < 0) {
+        PyErr_SetString(PyExc_ValueError, "length and offset must be non-negative integers");
+        return NULL;
+    }
+
+#ifdef PYUV_WINDOWS
+    UNUSED_ARG(self);
+    RAISE_UV_EXCEPTION(UV_ENOSYS, PyExc_FSError);
+    return NULL;
+#else
+    if (fstat(fd, &st) != 0) {
+        RAISE_UV_EXCEPTION(-errno, PyExc_FSError);
+        return NULL;
+    }
+
+    if (offset > (PY_LONG_LONG)st.st_size) {
+        PyErr_SetString(PyExc_ValueError, "offset is greater than the file size");
+        return NULL;
+    }
+    if (length == 0) {
+        length = (Py_ssize_t)(st.st_size - offset);
+        if (length == 0) {
+            PyErr_SetString(PyExc_ValueError, "cannot map an empty region");
+            return NULL;
+        }
+    } else if ((PY_LONG_LONG)length > (PY_LONG_LONG)st.st_size - offset) {
+        /* touching pages past the end of the file would raise SIGBUS */
+        PyErr_SetString(PyExc_ValueError, "length is greater than the file size");
+        return NULL;
+    }
+
+    delta = (size_t)(offset % pyuv__fs_page_size());
+    map_len = (size_t)length + delta;
+    map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, fd, (off_t)(offset - delta));
+    if (map == MAP_FAILED) {
+        RAISE_UV_EXCEPTION(-errno, PyExc_FSError);
         return NULL;
     }
 
-    Py_INCREF(fs_req);
-    if (callback != Py_None) {
-        /* No need to cleanup, it will be done in the callback */
-        return (PyObject *)fs_req;
-    } else {
-        pyuv__process_fs_req(&fs_req->req);
-        Py_INCREF(fs_req->result);
-        ret = fs_req->result;
-        Py_DECREF(fs_req);
-        return ret;
+    self = PyObject_New(MMap, &MMapType);
+    if (!self) {
+        munmap(map, map_len);
+        return NULL;
     }
+
+    Py_INCREF(loop);
+    self->loop = loop;
+    self->map = map;
+    self->map_len = map_len;
+    self->base = map + delta;
+    self->len = length;
+    self->exports = 0;
+
+    return (PyObject *)self;
+#endif
 }
 
 
@@ -1554,15 +4243,23 @@ FS_methods[] = {
     { "close", (PyCFunction)FS_func_close, METH_VARARGS|METH_KEYWORDS, "Close file." },
     { "read", (PyCFunction)FS_func_read, METH_VARARGS|METH_KEYWORDS, "Read data from a file." },
     { "write", (PyCFunction)FS_func_write, METH_VARARGS|METH_KEYWORDS, "Write data to a file." },
+    { "readinto", (PyCFunction)FS_func_readinto, METH_VARARGS|METH_KEYWORDS, "Read data from a file into the given buffers." },
+    { "writev", (PyCFunction)FS_func_writev, METH_VARARGS|METH_KEYWORDS, "Write the given buffers to a file." },
+    { "read_file", (PyCFunction)FS_func_read_file, METH_VARARGS|METH_KEYWORDS, "Read the entire contents of a file." },
+    { "write_file", (PyCFunction)FS_func_write_file, METH_VARARGS|METH_KEYWORDS, "Write data to a file, replacing its contents." },
+    { "batch", (PyCFunction)FS_func_batch, METH_VARARGS|METH_KEYWORDS, "Run many filesystem operations in the threadpool." },
+    { "walk", (PyCFunction)FS_func_walk, METH_VARARGS|METH_KEYWORDS, "Walk a directory tree recursively in the threadpool." },
     { "fsync", (PyCFunction)FS_func_fsync, METH_VARARGS|METH_KEYWORDS, "Sync all changes made to a file." },
     { "fdatasync", (PyCFunction)FS_func_fdatasync, METH_VARARGS|METH_KEYWORDS, "Sync data changes made to a file." },
     { "ftruncate", (PyCFunction)FS_func_ftruncate, METH_VARARGS|METH_KEYWORDS, "Truncate the contents of a file to the specified offset." },
     { "scandir", (PyCFunction)FS_func_scandir, METH_VARARGS|METH_KEYWORDS, "List files from a directory." },
+    { "copyfile", (PyCFunction)FS_func_copyfile, METH_VARARGS|METH_KEYWORDS, "Copy a file." },
     { "sendfile", (PyCFunction)FS_func_sendfile, METH_VARARGS|METH_KEYWORDS, "Sends a regular file to a stream socket." },
     { "utime", (PyCFunction)FS_func_utime, METH_VARARGS|METH_KEYWORDS, "Update file times." },
     { "futime", (PyCFunction)FS_func_futime, METH_VARARGS|METH_KEYWORDS, "Update file times." },
     { "access", (PyCFunction)FS_func_access, METH_VARARGS|METH_KEYWORDS, "Check access to file." },
     { "realpath", (PyCFunction)FS_func_realpath, METH_VARARGS|METH_KEYWORDS, "Returns the canonicalized absolute path." },
+    { "mmap", (PyCFunction)FS_func_mmap, METH_VARARGS|METH_KEYWORDS, "Map a file into memory." },
     { "stat_float_times", (PyCFunction)stat_float_times, METH_VARARGS, "Use floats for times in stat structs." },
     { NULL }
 };
@@ -1573,7 +4270,7 @@ FS_methods[] = {
 static void
 pyuv__fsevent_cb(uv_fs_event_t *handle, const char *filename, int events, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     FSEvent *self;
     PyObject *result, *py_filename, *py_events, *errorno;
 
@@ -1610,7 +4307,7 @@ pyuv__fsevent_cb(uv_fs_event_t *handle, const char *filename, int events, int st
     Py_DECREF(errorno);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -1827,7 +4524,7 @@ static PyTypeObject FSEventType = {
 static void
 pyuv__fspoll_cb(uv_fs_poll_t *handle, int status, const uv_stat_t *prev, const uv_stat_t *curr)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     FSPoll *self;
     PyObject *result, *errorno, *prev_stat_data, *curr_stat_data;
 
@@ -1872,7 +4569,7 @@ pyuv__fspoll_cb(uv_fs_poll_t *handle, int status, const uv_stat_t *prev, const u
     Py_XDECREF(result);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -2090,6 +4787,504 @@ static PyTypeObject FSPollType = {
 };
 
 
+/* AsyncFileWriter */
+
+/*
+ * Group commit: appended records are queued on the loop thread and written by a single
+ * threadpool job at a time, followed by one fdatasync. Records appended while a batch is in
+ * flight make up the next one, so the sync cost is shared by everything queued meanwhile.
+ */
+static void
+pyuv__fs_writer_work_cb(uv_work_t *req)
+{
+    AsyncFileWriter *self;
+    uv_fs_t fs_req;
+    uv_buf_t *bufs;
+    unsigned int nbufs;
+    int r;
+
+    ASSERT(req);
+    self = PYUV_CONTAINER_OF(req, AsyncFileWriter, work_req);
+
+    bufs = self->bufs;
+    nbufs = self->nbufs;
+    self->batch_result = 0;
+
+    while (nbufs > 0) {
+        r = uv_fs_write(req->loop, &fs_req, self->fd, bufs, nbufs, -1, NULL);
+        uv_fs_req_cleanup(&fs_req);
+        if (r == UV_EINTR) {
+            continue;
+        }
+        if (r < 0) {
+            self->batch_result = r;
+            return;
+        }
+        /* skip whatever got written, short writes are retried with the rest */
+        while (nbufs > 0 && (size_t)r >= bufs->len) {
+            r -= bufs->len;
+            bufs++;
+            nbufs--;
+        }
+        if (nbufs > 0) {
+            bufs->base += r;
+            bufs->len -= r;
+        }
+    }
+
+    if (self->datasync) {
+        r = uv_fs_fdatasync(req->loop, &fs_req, self->fd, NULL);
+        uv_fs_req_cleanup(&fs_req);
+        if (r < 0) {
+            self->batch_result = r;
+        }
+    }
+}
+
+
+static void
+pyuv__fs_writer_complete(AsyncFileWriter *self, fs_writer_record *records, int err)
+{
+    fs_writer_record *record;
+    PyObject *result, *errorno;
+
+    if (err < 0) {
+        errorno = PyInt_FromLong((long)err);
+    } else {
+        Py_INCREF(Py_None);
+        errorno = Py_None;
+    }
+
+    while (records) {
+        record = records;
+        records = record->next;
+        self->count--;
+        PyBuffer_Release(&record->view);
+        if (record->callback != Py_None) {
+            result = PyObject_CallFunctionObjArgs(record->callback, self, errorno, NULL);
+            if (result == NULL) {
+                handle_uncaught_exception(self->loop);
+            }
+            Py_XDECREF(result);
+        }
+        Py_DECREF(record->callback);
+        PyMem_Free(record);
+    }
+
+    Py_XDECREF(errorno);
+}
+
+
+static void pyuv__fs_writer_done_cb(uv_work_t *req, int status);
+
+/* Take records from the pending queue, up to max_batch_size bytes, and write them */
+static int
+pyuv__fs_writer_start(AsyncFileWriter *self)
+{
+    fs_writer_record *record, *last;
+    size_t bytes;
+    unsigned int n;
+    int err;
+
+    ASSERT(!self->busy);
+    ASSERT(self->pending_head);
+
+    bytes = 0;
+    n = 0;
+    last = NULL;
+    for (record = self->pending_head; record; record = record->next) {
+        if (n > 0 && (n == PYUV_WRITER_MAX_RECORDS || bytes + record->view.len > self->max_batch_size)) {
+            break;
+        }
+        bytes += record->view.len;
+        n++;
+        last = record;
+    }
+
+    self->bufs = PyMem_Malloc(sizeof(uv_buf_t) * n);
+    if (!self->bufs) {
+        return UV_ENOMEM;
+    }
+    self->nbufs = n;
+    self->batch = self->pending_head;
+    self->pending_head = last->next;
+    if (!self->pending_head) {
+        self->pending_tail = NULL;
+    }
+    last->next = NULL;
+
+    n = 0;
+    for (record = self->batch; record; record = record->next) {
+        self->bufs[n++] = uv_buf_init(record->view.buf, (unsigned int)record->view.len);
+    }
+
+    self->stats.last_batch_records = self->nbufs;
+    self->stats.last_batch_bytes = bytes;
+    self->batch_start = uv_hrtime();
+
+    err = uv_queue_work(self->loop->uv_loop, &self->work_req, pyuv__fs_writer_work_cb, pyuv__fs_writer_done_cb);
+    if (err < 0) {
+        /* put the records back where they were */
+        last->next = self->pending_head;
+        self->pending_head = self->batch;
+        if (!self->pending_tail) {
+            self->pending_tail = last;
+        }
+        self->batch = NULL;
+        PyMem_Free(self->bufs);
+        self->bufs = NULL;
+        self->nbufs = 0;
+        return err;
+    }
+
+    self->busy = True;
+    /* Keep the writer alive while the batch is in flight */
+    Py_INCREF(self);
+    return 0;
+}
+
+
+static void
+pyuv__fs_writer_done_cb(uv_work_t *req, int status)
+{
+    AsyncFileWriter *self;
+    fs_writer_record *records, *pending;
+    uint64_t latency;
+    int err, r, gstate;
+
+    ASSERT(req);
+    self = PYUV_CONTAINER_OF(req, AsyncFileWriter, work_req);
+    gstate = pyuv__gil_ensure(self->loop->uv_loop);
+
+    err = status == UV_ECANCELED ? status : self->batch_result;
+    latency = uv_hrtime() - self->batch_start;
+
+    self->stats.batches++;
+    self->stats.records += self->stats.last_batch_records;
+    if (err == 0) {
+        self->stats.bytes += self->stats.last_batch_bytes;
+    }
+    if (self->stats.last_batch_records > self->stats.max_batch_records) {
+        self->stats.max_batch_records = self->stats.last_batch_records;
+    }
+    self->stats.last_latency = latency;
+    if (latency > self->stats.max_latency) {
+        self->stats.max_latency = latency;
+    }
+    self->stats.total_latency += latency;
+
+    records = self->batch;
+    self->batch = NULL;
+    PyMem_Free(self->bufs);
+    self->bufs = NULL;
+    self->nbufs = 0;
+    self->busy = False;
+
+    /* Get the next batch going before running the callbacks for this one */
+    if (self->pending_head) {
+        r = pyuv__fs_writer_start(self);
+        if (r < 0) {
+            pending = self->pending_head;
+            self->pending_head = self->pending_tail = NULL;
+            pyuv__fs_writer_complete(self, pending, r);
+        }
+    }
+
+    pyuv__fs_writer_complete(self, records, err);
+
+    Py_DECREF(self);
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+AsyncFileWriter_func_append(AsyncFileWriter *self, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    fs_writer_record *record;
+    PyObject *data, *callback;
+
+    static char *kwlist[] = {"data", "callback", NULL};
+
+    RAISE_IF_NOT_INITIALIZED(self, NULL);
+
+    callback = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O:append", kwlist, &data, &callback)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable or None is required");
+        return NULL;
+    }
+
+    record = PyMem_Malloc(sizeof *record);
+    if (!record) {
+        return PyErr_NoMemory();
+    }
+
+    if (PyObject_GetBuffer(data, &record->view, PyBUF_SIMPLE) != 0) {
+        PyMem_Free(record);
+        return NULL;
+    }
+
+    Py_INCREF(callback);
+    record->callback = callback;
+    record->next = NULL;
+
+    if (self->pending_tail) {
+        self->pending_tail->next = record;
+    } else {
+        self->pending_head = record;
+    }
+    self->pending_tail = record;
+    self->count++;
+
+    if (!self->busy) {
+        err = pyuv__fs_writer_start(self);
+        if (err < 0) {
+            /* the record is the only one pending, the queue is empty while idle */
+            self->pending_head = self->pending_tail = NULL;
+            self->count--;
+            PyBuffer_Release(&record->view);
+            Py_DECREF(record->callback);
+            PyMem_Free(record);
+            RAISE_UV_EXCEPTION(err, PyExc_FSError);
+            return NULL;
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+AsyncFileWriter_fd_get(AsyncFileWriter *self, void *closure)
+{
+    UNUSED_ARG(closure);
+
+    RAISE_IF_NOT_INITIALIZED(self, NULL);
+
+    return PyInt_FromLong((long)self->fd);
+}
+
+
+static PyObject *
+AsyncFileWriter_pending_get(AsyncFileWriter *self, void *closure)
+{
+    UNUSED_ARG(closure);
+
+    RAISE_IF_NOT_INITIALIZED(self, NULL);
+
+    return PyInt_FromSsize_t(self->count);
+}
+
+
+static PyObject *
+AsyncFileWriter_active_get(AsyncFileWriter *self, void *closure)
+{
+    UNUSED_ARG(closure);
+
+    RAISE_IF_NOT_INITIALIZED(self, NULL);
+
+    return PyBool_FromLong((long)self->busy);
+}
+
+
+static PyObject *
+AsyncFileWriter_stats_get(AsyncFileWriter *self, void *closure)
+{
+    PyObject *stats;
+    double avg_latency;
+
+    UNUSED_ARG(closure);
+
+    RAISE_IF_NOT_INITIALIZED(self, NULL);
+
+    stats = PyStructSequence_New(&AsyncFileWriterStatsType);
+    if (!stats) {
+        return NULL;
+    }
+
+    avg_latency = self->stats.batches ? ((double)self->stats.total_latency / self->stats.batches) / 1e9 : 0.0;
+
+    PyStructSequence_SET_ITEM(stats, 0, PyLong_FromUnsignedLongLong(self->stats.batches));
+    PyStructSequence_SET_ITEM(stats, 1, PyLong_FromUnsignedLongLong(self->stats.records));
+    PyStructSequence_SET_ITEM(stats, 2, PyLong_FromUnsignedLongLong(self->stats.bytes));
+    PyStructSequence_SET_ITEM(stats, 3, PyInt_FromSsize_t(self->stats.last_batch_records));
+    PyStructSequence_SET_ITEM(stats, 4, PyLong_FromSize_t(self->stats.last_batch_bytes));
+    PyStructSequence_SET_ITEM(stats, 5, PyInt_FromSsize_t(self->stats.max_batch_records));
+    PyStructSequence_SET_ITEM(stats, 6, PyFloat_FromDouble(self->stats.last_latency / 1e9));
+    PyStructSequence_SET_ITEM(stats, 7, PyFloat_FromDouble(self->stats.max_latency / 1e9));
+    PyStructSequence_SET_ITEM(stats, 8, PyFloat_FromDouble(avg_latency));
+
+    if (PyErr_Occurred()) {
+        Py_DECREF(stats);
+        return NULL;
+    }
+
+    return stats;
+}
+
+
+static int
+AsyncFileWriter_tp_init(AsyncFileWriter *self, PyObject *args, PyObject *kwargs)
+{
+    int fd;
+    Py_ssize_t max_batch_size;
+    Loop *loop;
+    PyObject *datasync;
+
+    static char *kwlist[] = {"loop", "fd", "datasync", "max_batch_size", NULL};
+
+    RAISE_IF_INITIALIZED(self, -1);
+
+    datasync = Py_True;
+    max_batch_size = 1024 * 1024;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!i|On:__init__", kwlist, &LoopType, &loop, &fd, &datasync, &max_batch_size)) {
+        return -1;
+    }
+
+    if (fd < 0) {
+        PyErr_SetString(PyExc_ValueError, "fd must be a non-negative integer");
+        return -1;
+    }
+
+    if (max_batch_size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "max_batch_size must be a positive integer");
+        return -1;
+    }
+
+    Py_INCREF(loop);
+    self->loop = loop;
+    self->fd = fd;
+    self->datasync = PyObject_IsTrue(datasync) ? True : False;
+    self->max_batch_size = (size_t)max_batch_size;
+    self->initialized = True;
+
+    return 0;
+}
+
+
+static PyObject *
+AsyncFileWriter_tp_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    AsyncFileWriter *self;
+
+    self = (AsyncFileWriter *)PyType_GenericNew(type, args, kwargs);
+    if (!self) {
+        return NULL;
+    }
+    self->initialized = False;
+    self->busy = False;
+    self->loop = NULL;
+    self->pending_head = self->pending_tail = NULL;
+    self->batch = NULL;
+    self->bufs = NULL;
+    self->nbufs = 0;
+    self->count = 0;
+    memset(&self->stats, 0, sizeof(self->stats));
+    return (PyObject *)self;
+}
+
+
+static int
+AsyncFileWriter_tp_traverse(AsyncFileWriter *self, visitproc visit, void *arg)
+{
+    fs_writer_record *record;
+
+    Py_VISIT(self->loop);
+    for (record = self->pending_head; record; record = record->next) {
+        Py_VISIT(record->callback);
+    }
+    for (record = self->batch; record; record = record->next) {
+        Py_VISIT(record->callback);
+    }
+    return 0;
+}
+
+
+static int
+AsyncFileWriter_tp_clear(AsyncFileWriter *self)
+{
+    /* Records only exist while a batch is in flight, which holds a reference to the writer */
+    ASSERT(!self->busy && !self->pending_head);
+    Py_CLEAR(self->loop);
+    return 0;
+}
+
+
+static void
+AsyncFileWriter_tp_dealloc(AsyncFileWriter *self)
+{
+    PyObject_GC_UnTrack(self);
+    Py_TYPE(self)->tp_clear((PyObject *)self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+static PyMethodDef
+AsyncFileWriter_tp_methods[] = {
+    { "append", (PyCFunction)AsyncFileWriter_func_append, METH_VARARGS | METH_KEYWORDS, "Append data to the file." },
+    { NULL }
+};
+
+
+static PyGetSetDef AsyncFileWriter_tp_getsets[] = {
+    {"fd", (getter)AsyncFileWriter_fd_get, NULL, "File descriptor being written to.", NULL},
+    {"pending", (getter)AsyncFileWriter_pending_get, NULL, "Number of records which are not durable yet.", NULL},
+    {"active", (getter)AsyncFileWriter_active_get, NULL, "Indicates if a batch is being written.", NULL},
+    {"stats", (getter)AsyncFileWriter_stats_get, NULL, "Batch size and latency statistics.", NULL},
+    {NULL}
+};
+
+
+static PyTypeObject AsyncFileWriterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyuv._cpyuv.fs.AsyncFileWriter",                               /*tp_name*/
+    sizeof(AsyncFileWriter),                                        /*tp_basicsize*/
+    0,                                                              /*tp_itemsize*/
+    (destructor)AsyncFileWriter_tp_dealloc,                         /*tp_dealloc*/
+    0,                                                              /*tp_print*/
+    0,                                                              /*tp_getattr*/
+    0,                                                              /*tp_setattr*/
+    0,                                                              /*tp_compare*/
+    0,                                                              /*tp_repr*/
+    0,                                                              /*tp_as_number*/
+    0,                                                              /*tp_as_sequence*/
+    0,                                                              /*tp_as_mapping*/
+    0,                                                              /*tp_hash */
+    0,                                                              /*tp_call*/
+    0,                                                              /*tp_str*/
+    0,                                                              /*tp_getattro*/
+    0,                                                              /*tp_setattro*/
+    0,                                                              /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,  /*tp_flags*/
+    0,                                                              /*tp_doc*/
+    (traverseproc)AsyncFileWriter_tp_traverse,                      /*tp_traverse*/
+    (inquiry)AsyncFileWriter_tp_clear,                              /*tp_clear*/
+    0,                                                              /*tp_richcompare*/
+    0,                                                              /*tp_weaklistoffset*/
+    0,                                                              /*tp_iter*/
+    0,                                                              /*tp_iternext*/
+    AsyncFileWriter_tp_methods,                                     /*tp_methods*/
+    0,                                                              /*tp_members*/
+    AsyncFileWriter_tp_getsets,                                     /*tp_getsets*/
+    0,                                                              /*tp_base*/
+    0,                                                              /*tp_dict*/
+    0,                                                              /*tp_descr_get*/
+    0,                                                              /*tp_descr_set*/
+    0,                                                              /*tp_dictoffset*/
+    (initproc)AsyncFileWriter_tp_init,                              /*tp_init*/
+    0,                                                              /*tp_alloc*/
+    AsyncFileWriter_tp_new,                                         /*tp_new*/
+};
+
+
+
+
 
 #ifdef PYUV_PYTHON3
 static PyModuleDef pyuv_fs_module = {
@@ -2128,18 +5323,33 @@ init_fs(void)
     PyModule_AddIntMacro(module, UV_DIRENT_SOCKET);
     PyModule_AddIntMacro(module, UV_DIRENT_CHAR);
     PyModule_AddIntMacro(module, UV_DIRENT_BLOCK);
+    PyModule_AddIntMacro(module, UV_FS_COPYFILE_EXCL);
+    PyModule_AddIntMacro(module, UV_FS_COPYFILE_FICLONE_FORCE);
+#ifndef PYUV_WINDOWS
+    PyModule_AddIntMacro(module, MADV_NORMAL);
+    PyModule_AddIntMacro(module, MADV_RANDOM);
+    PyModule_AddIntMacro(module, MADV_SEQUENTIAL);
+    PyModule_AddIntMacro(module, MADV_WILLNEED);
+    PyModule_AddIntMacro(module, MADV_DONTNEED);
+#endif
 
     FSEventType.tp_base = &HandleType;
     FSPollType.tp_base = &HandleType;
 
     PyUVModule_AddType(module, "FSEvent", &FSEventType);
     PyUVModule_AddType(module, "FSPoll", &FSPollType);
+    PyUVModule_AddType(module, "AsyncFileWriter", &AsyncFileWriterType);
+    PyUVModule_AddType(module, "MMap", &MMapType);
 
     /* initialize PyStructSequence types */
     if (StatResultType.tp_name == 0)
         PyStructSequence_InitType(&StatResultType, &stat_result_desc);
     if (DirEntType.tp_name == 0)
         PyStructSequence_InitType(&DirEntType, &dirent_desc);
+    if (WalkEntryType.tp_name == 0)
+        PyStructSequence_InitType(&WalkEntryType, &walk_entry_desc);
+    if (AsyncFileWriterStatsType.tp_name == 0)
+        PyStructSequence_InitType(&AsyncFileWriterStatsType, &writer_stats_desc);
 
     return module;
 }
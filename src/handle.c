@@ -45,7 +45,7 @@ resurrect_object(PyObject *self)
 static void
 pyuv__handle_close_cb(uv_handle_t *handle)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Handle *self;
     PyObject *result;
     ASSERT(handle);
@@ -53,6 +53,11 @@ pyuv__handle_close_cb(uv_handle_t *handle)
     /* Can't use container_of here */
     self = (Handle *)handle->data;
 
+    /* Writes which completed synchronously must be reported before the handle is closed */
+    if (self->loop->deferred.head != NULL) {
+        pyuv__loop_flush_deferred(self->loop);
+    }
+
     if (self->on_close_cb != Py_None) {
         result = PyObject_CallFunctionObjArgs(self->on_close_cb, self, NULL);
         if (result == NULL) {
@@ -74,14 +79,14 @@ pyuv__handle_close_cb(uv_handle_t *handle)
     /* Refcount was increased in the caller function */
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
 static void
 pyuv__handle_dealloc_close_cb(uv_handle_t *handle)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Handle *self;
 
     ASSERT(handle);
@@ -90,7 +95,7 @@ pyuv__handle_dealloc_close_cb(uv_handle_t *handle)
     self = (Handle *)handle->data;
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -124,6 +129,11 @@ Handle_func_close(Handle *self, PyObject *args)
         return NULL;
     }
 
+    /* Buffered writes are submitted, libuv will either write them or cancel them */
+    if (PyObject_TypeCheck(self, &StreamType)) {
+        pyuv__stream_flush_writes((Stream *)self);
+    }
+
     Py_INCREF(callback);
     self->on_close_cb = callback;
 
@@ -2,6 +2,82 @@
 static PyObject *default_loop = NULL;
 
 
+static void
+pyuv__loop_gil_prepare_cb(uv_prepare_t *handle)
+{
+    Loop *loop;
+
+    loop = handle->loop->data;
+    ASSERT(loop);
+
+    /* Release the GIL right before blocking for i/o, it will be reacquired by the first
+     * callback which needs it. Don't bother if the poll won't block. */
+    if (loop->gil.active && loop->gil.tstate == NULL && uv_backend_timeout(handle->loop) != 0) {
+        loop->gil.tstate = PyEval_SaveThread();
+    }
+}
+
+
+/* Run the callbacks of write requests which completed synchronously. Requests deferred
+ * while the callbacks run are left for the next iteration. */
+static void
+pyuv__loop_flush_deferred(Loop *loop)
+{
+    uv_write_t *req, *next;
+
+    req = loop->deferred.head;
+    loop->deferred.head = loop->deferred.tail = NULL;
+
+    while (req != NULL) {
+        next = req->data;
+        req->cb(req, 0);
+        req = next;
+    }
+
+    if (loop->deferred.head == NULL && loop->deferred.initialized) {
+        uv_idle_stop(&loop->deferred.idle_h);
+    }
+}
+
+
+static void
+pyuv__loop_deferred_cb(uv_idle_t *handle)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    Loop *loop;
+
+    loop = handle->loop->data;
+    ASSERT(loop);
+
+    pyuv__loop_flush_deferred(loop);
+
+    pyuv__gil_release(gstate);
+}
+
+
+/* Queue a write request which was completed synchronously, its callback will be called on
+ * the next loop iteration. The request must have its handle and cb fields set. */
+static void
+pyuv__loop_defer_write(Loop *loop, uv_write_t *req)
+{
+    if (!loop->deferred.initialized) {
+        uv_idle_init(loop->uv_loop, &loop->deferred.idle_h);
+        loop->deferred.idle_h.data = NULL;
+        loop->deferred.initialized = True;
+    }
+
+    req->data = NULL;
+    if (loop->deferred.tail != NULL) {
+        loop->deferred.tail->data = req;
+    } else {
+        loop->deferred.head = req;
+    }
+    loop->deferred.tail = req;
+
+    uv_idle_start(&loop->deferred.idle_h, pyuv__loop_deferred_cb);
+}
+
+
 static PyObject *
 new_loop(PyTypeObject *type, PyObject *args, PyObject *kwargs, int is_default)
 {
@@ -36,7 +112,26 @@ new_loop(PyTypeObject *type, PyObject *args, PyObject *kwargs, int is_default)
     loop->uv_loop = uv_loop;
     loop->is_default = is_default;
     loop->weakreflist = NULL;
-    loop->buffer.in_use = False;
+    loop->buffer.free_list = NULL;
+    loop->buffer.size = PYUV_BUFFER_SIZE;
+    loop->buffer.depth = PYUV_BUFFER_POOL_DEPTH;
+    loop->buffer.free_count = 0;
+    loop->buffer.in_use = 0;
+    loop->buffer.memory = 0;
+    loop->buffer.hits = 0;
+    loop->buffer.misses = 0;
+    memset(&loop->reqs, 0, sizeof(loop->reqs));
+    loop->reqs.depth = PYUV_REQ_CACHE_DEPTH;
+    loop->deferred.head = NULL;
+    loop->deferred.tail = NULL;
+    loop->deferred.initialized = False;
+    loop->coalesce.streams = NULL;
+    loop->coalesce.initialized = False;
+    loop->gil.tstate = NULL;
+    loop->gil.hold = False;
+    loop->gil.active = False;
+    loop->gil.prepare_started = False;
+    loop->uring = NULL;
 
     return obj;
 }
@@ -58,9 +153,19 @@ Loop_func_run(Loop *self, PyObject *args)
         return NULL;
     }
 
-    Py_BEGIN_ALLOW_THREADS
-    r = uv_run(self->uv_loop, mode);
-    Py_END_ALLOW_THREADS
+    if (self->gil.hold) {
+        self->gil.active = True;
+        r = uv_run(self->uv_loop, mode);
+        if (self->gil.tstate != NULL) {
+            PyEval_RestoreThread(self->gil.tstate);
+            self->gil.tstate = NULL;
+        }
+        self->gil.active = False;
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        r = uv_run(self->uv_loop, mode);
+        Py_END_ALLOW_THREADS
+    }
 
     return PyBool_FromLong((long)r);
 }
@@ -126,7 +231,7 @@ pyuv__tp_work_cb(uv_work_t *req)
 static void
 pyuv__tp_done_cb(uv_work_t *req, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->loop);
     WorkRequest *work_req;
     Loop *loop;
     PyObject *result, *errorno;
@@ -155,7 +260,7 @@ pyuv__tp_done_cb(uv_work_t *req, int status)
     UV_REQUEST(work_req) = NULL;
     Py_DECREF(work_req);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 static PyObject *
@@ -293,6 +398,247 @@ Loop_handles_get(Loop *self, void *closure)
 }
 
 
+static PyObject *
+Loop_hold_gil_get(Loop *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyBool_FromLong((long)self->gil.hold);
+}
+
+
+static int
+Loop_hold_gil_set(Loop *self, PyObject *value, void *closure)
+{
+    int hold;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    hold = PyObject_IsTrue(value);
+    if (hold == -1) {
+        return -1;
+    }
+
+    if (self->gil.active) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot change hold_gil while the loop is running");
+        return -1;
+    }
+
+    if (hold && !self->gil.prepare_started) {
+        uv_prepare_init(self->uv_loop, &self->gil.prepare_h);
+        uv_prepare_start(&self->gil.prepare_h, pyuv__loop_gil_prepare_cb);
+        uv_unref((uv_handle_t *)&self->gil.prepare_h);
+        self->gil.prepare_started = True;
+    }
+
+    self->gil.hold = hold ? True : False;
+    return 0;
+}
+
+
+static PyObject *
+Loop_io_uring_get(Loop *self, void *closure)
+{
+    UNUSED_ARG(closure);
+
+    return PyBool_FromLong((long)pyuv__uring_enabled(self));
+}
+
+
+static int
+Loop_io_uring_set(Loop *self, PyObject *value, void *closure)
+{
+    int enable;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    enable = PyObject_IsTrue(value);
+    if (enable == -1) {
+        return -1;
+    }
+
+    /* If io_uring is not available fs operations keep using the threadpool */
+    if (enable) {
+        pyuv__uring_enable(self);
+    } else {
+        pyuv__uring_disable(self);
+    }
+
+    return 0;
+}
+
+
+static PyObject *
+Loop_buffer_size_get(Loop *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyLong_FromSize_t(self->buffer.size);
+}
+
+
+static int
+Loop_buffer_size_set(Loop *self, PyObject *value, void *closure)
+{
+    long size;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    size = PyInt_AsLong(value);
+    if (size == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+
+    if (size <= 0 || size > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "buffer_size must be a positive integer");
+        return -1;
+    }
+
+    if ((size_t)size != self->buffer.size) {
+        /* Pooled buffers have the old size, buffers in use are freed when returned */
+        pyuv__buffer_trim(self, 0);
+        self->buffer.size = (size_t)size;
+    }
+
+    return 0;
+}
+
+
+static PyObject *
+Loop_buffer_pool_size_get(Loop *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyInt_FromLong((long)self->buffer.depth);
+}
+
+
+static int
+Loop_buffer_pool_size_set(Loop *self, PyObject *value, void *closure)
+{
+    long depth;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    depth = PyInt_AsLong(value);
+    if (depth == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+
+    if (depth < 0 || depth > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "buffer_pool_size must be a positive integer or zero");
+        return -1;
+    }
+
+    self->buffer.depth = (unsigned int)depth;
+    pyuv__buffer_trim(self, self->buffer.depth);
+
+    return 0;
+}
+
+
+static PyObject *
+Loop_buffer_stats_get(Loop *self, void *closure)
+{
+    PyObject *stats;
+
+    UNUSED_ARG(closure);
+
+    stats = PyStructSequence_New(&BufferStatsResultType);
+    if (!stats) {
+        return NULL;
+    }
+
+    PyStructSequence_SET_ITEM(stats, 0, PyLong_FromSize_t(self->buffer.memory));
+    PyStructSequence_SET_ITEM(stats, 1, PyInt_FromLong((long)self->buffer.in_use));
+    PyStructSequence_SET_ITEM(stats, 2, PyInt_FromLong((long)self->buffer.free_count));
+    PyStructSequence_SET_ITEM(stats, 3, PyLong_FromUnsignedLongLong(self->buffer.hits));
+    PyStructSequence_SET_ITEM(stats, 4, PyLong_FromUnsignedLongLong(self->buffer.misses));
+
+    return stats;
+}
+
+
+static PyObject *
+Loop_request_cache_size_get(Loop *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyInt_FromLong((long)self->reqs.depth);
+}
+
+
+static int
+Loop_request_cache_size_set(Loop *self, PyObject *value, void *closure)
+{
+    long depth;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    depth = PyInt_AsLong(value);
+    if (depth == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+
+    if (depth < 0 || depth > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "request_cache_size must be a positive integer or zero");
+        return -1;
+    }
+
+    self->reqs.depth = (unsigned int)depth;
+    pyuv__req_trim_all(self, self->reqs.depth);
+
+    return 0;
+}
+
+
+static PyObject *
+Loop_request_cache_stats_get(Loop *self, void *closure)
+{
+    PyObject *stats;
+    unsigned int free_count;
+
+    UNUSED_ARG(closure);
+
+    stats = PyStructSequence_New(&RequestCacheStatsResultType);
+    if (!stats) {
+        return NULL;
+    }
+
+    free_count = self->reqs.write.free_count + self->reqs.shutdown.free_count + self->reqs.udp_send.free_count +
+                 self->reqs.proxy_write.free_count;
+
+    PyStructSequence_SET_ITEM(stats, 0, PyInt_FromLong((long)self->reqs.in_use));
+    PyStructSequence_SET_ITEM(stats, 1, PyInt_FromLong((long)free_count));
+    PyStructSequence_SET_ITEM(stats, 2, PyLong_FromUnsignedLongLong(self->reqs.hits));
+    PyStructSequence_SET_ITEM(stats, 3, PyLong_FromUnsignedLongLong(self->reqs.misses));
+    PyStructSequence_SET_ITEM(stats, 4, PyLong_FromUnsignedLongLong(self->reqs.trimmed));
+
+    return stats;
+}
+
+
 static PyObject *
 Loop_alive_get(Loop *self, void *closure)
 {
@@ -312,6 +658,7 @@ static int
 Loop_tp_traverse(Loop *self, visitproc visit, void *arg)
 {
     Py_VISIT(self->dict);
+    Py_VISIT(self->coalesce.streams);
     return 0;
 }
 
@@ -320,17 +667,52 @@ static int
 Loop_tp_clear(Loop *self)
 {
     Py_CLEAR(self->dict);
+    Py_CLEAR(self->coalesce.streams);
     return 0;
 }
 
 
+static void
+count_walk_cb(uv_handle_t* handle, void* arg)
+{
+    UNUSED_ARG(handle);
+    (*(int *)arg)++;
+}
+
 static void
 Loop_tp_dealloc(Loop *self)
 {
+    int count, internal;
+
     if (self->uv_loop) {
+        count = internal = 0;
+        uv_walk(self->uv_loop, count_walk_cb, &count);
+        if (self->gil.prepare_started) {
+            uv_close((uv_handle_t *)&self->gil.prepare_h, NULL);
+            internal++;
+        }
+        if (self->deferred.initialized) {
+            uv_close((uv_handle_t *)&self->deferred.idle_h, NULL);
+            internal++;
+        }
+        if (self->coalesce.initialized) {
+            uv_close((uv_handle_t *)&self->coalesce.prepare_h, NULL);
+            internal++;
+        }
+        if (self->reqs.timer_initialized) {
+            uv_close((uv_handle_t *)&self->reqs.trim_timer, NULL);
+            internal++;
+        }
+        internal += pyuv__uring_close(self);
+        /* Only spin the loop to finish closing the internal handles if they were the last ones */
+        if (internal > 0 && count == internal) {
+            uv_run(self->uv_loop, UV_RUN_NOWAIT);
+        }
         self->uv_loop->data = NULL;
         uv_loop_close(self->uv_loop);
     }
+    pyuv__buffer_trim(self, 0);
+    pyuv__req_trim_all(self, 0);
     if (self->weakreflist != NULL) {
         PyObject_ClearWeakRefs((PyObject *)self);
     }
@@ -396,8 +778,15 @@ Loop_tp_methods[] = {
 static PyGetSetDef Loop_tp_getsets[] = {
     {"__dict__", (getter)Loop_dict_get, (setter)Loop_dict_set, NULL},
     {"alive", (getter)Loop_alive_get, NULL, "Indicates if the loop is still running / alive", NULL},
+    {"buffer_size", (getter)Loop_buffer_size_get, (setter)Loop_buffer_size_set, "Size of the buffers used for reading", NULL},
+    {"buffer_pool_size", (getter)Loop_buffer_pool_size_get, (setter)Loop_buffer_pool_size_set, "Maximum number of unused read buffers kept around", NULL},
+    {"buffer_stats", (getter)Loop_buffer_stats_get, NULL, "Read buffer pool statistics", NULL},
+    {"request_cache_size", (getter)Loop_request_cache_size_get, (setter)Loop_request_cache_size_set, "Maximum number of unused request contexts kept around per kind", NULL},
+    {"request_cache_stats", (getter)Loop_request_cache_stats_get, NULL, "Request context cache statistics", NULL},
     {"default", (getter)Loop_default_get, NULL, "Is this the default loop?", NULL},
     {"handles", (getter)Loop_handles_get, NULL, "Returns a list with all handles in the Loop", NULL},
+    {"hold_gil", (getter)Loop_hold_gil_get, (setter)Loop_hold_gil_set, "Hold the GIL while running callbacks, release it only when polling for i/o", NULL},
+    {"io_uring", (getter)Loop_io_uring_get, (setter)Loop_io_uring_set, "Run fs operations through io_uring when available", NULL},
     {NULL}
 };
 
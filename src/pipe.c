@@ -2,7 +2,7 @@
 static void
 pyuv__pipe_listen_cb(uv_stream_t* handle, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Pipe *self;
     PyObject *result, *py_errorno;
     ASSERT(handle);
@@ -27,14 +27,14 @@ pyuv__pipe_listen_cb(uv_stream_t* handle, int status)
     Py_DECREF(py_errorno);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
 static void
 pyuv__pipe_connect_cb(uv_connect_t *req, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->handle->loop);
     Pipe *self;
     PyObject *callback, *result, *py_errorno;
     ASSERT(req);
@@ -64,7 +64,7 @@ pyuv__pipe_connect_cb(uv_connect_t *req, int status)
     /* Refcount was increased in the caller function */
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -2,7 +2,7 @@
 static void
 pyuv__poll_cb(uv_poll_t *handle, int status, int events)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Poll *self;
     PyObject *result, *py_events, *py_errorno;
 
@@ -30,7 +30,7 @@ pyuv__poll_cb(uv_poll_t *handle, int status, int events)
     Py_XDECREF(result);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
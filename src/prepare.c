@@ -2,7 +2,9 @@
 static void
 pyuv__prepare_cb(uv_prepare_t *handle)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    Loop *loop = handle->loop->data;
+    Bool released = loop->gil.tstate != NULL;
+    int gstate = pyuv__gil_ensure(handle->loop);
     Prepare *self;
     PyObject *result;
 
@@ -19,7 +21,12 @@ pyuv__prepare_cb(uv_prepare_t *handle)
     Py_XDECREF(result);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
+
+    /* The loop had already released the GIL ahead of polling, release it again */
+    if (released && loop->gil.tstate == NULL) {
+        loop->gil.tstate = PyEval_SaveThread();
+    }
 }
 
 
@@ -176,7 +176,7 @@ static PyObject* Process_tp_new(PyTypeObject *type, PyObject *args, PyObject *kw
 static void
 pyuv__process_exit_cb(uv_process_t *handle, int64_t exit_status, int term_signal)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Process *self;
     PyObject *result, *py_exit_status, *py_term_signal;
 
@@ -200,7 +200,7 @@ pyuv__process_exit_cb(uv_process_t *handle, int64_t exit_status, int term_signal
     /* Refcount was increased in the spawn function */
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
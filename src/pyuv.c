@@ -4,6 +4,7 @@
 #include "common.c"
 #include "errno.c"
 #include "error.c"
+#include "address.c"
 #include "loop.c"
 #include "handle.c"
 #include "request.c"
@@ -23,6 +24,7 @@
 #include "udp.c"
 #include "poll.c"
 #include "fs.c"
+#include "uring.c"
 #include "process.c"
 #include "dns.c"
 #include "util.c"
@@ -186,6 +188,21 @@ init_pyuv(void)
         return NULL;
     }
 
+    if (PyType_Ready(&ReadBufferType) < 0) {
+        return NULL;
+    }
+    AddressType.tp_base = &PyTuple_Type;
+    if (PyType_Ready(&AddressType) < 0) {
+        return NULL;
+    }
+
+    if (BufferStatsResultType.tp_name == 0)
+        PyStructSequence_InitType(&BufferStatsResultType, &buffer_stats_result_desc);
+    if (RequestCacheStatsResultType.tp_name == 0)
+        PyStructSequence_InitType(&RequestCacheStatsResultType, &request_cache_stats_result_desc);
+    if (PipeStatsResultType.tp_name == 0)
+        PyStructSequence_InitType(&PipeStatsResultType, &pipe_stats_result_desc);
+
     PyUVModule_AddType(pyuv, "Loop", &LoopType);
     PyUVModule_AddType(pyuv, "Async", &AsyncType);
     PyUVModule_AddType(pyuv, "Timer", &TimerType);
@@ -200,6 +217,7 @@ init_pyuv(void)
     PyUVModule_AddType(pyuv, "Poll", &PollType);
     PyUVModule_AddType(pyuv, "StdIO", &StdIOType);
     PyUVModule_AddType(pyuv, "Process", &ProcessType);
+    PyUVModule_AddType(pyuv, "Address", &AddressType);
 
     /* Handle and Stream base classes */
     PyUVModule_AddType(pyuv, "Handle", &HandleType);
@@ -45,6 +45,12 @@ typedef int Bool;
     #define PYUV_MAXSTDIO 2048
 #endif
 
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define PYUV_HAVE_IO_URING
+    #endif
+#endif
+
 #ifdef _MSC_VER
     #define INLINE __inline
 #else
@@ -143,7 +149,23 @@ typedef int Bool;
         (x) = Py_None;       \
     } while(0)               \
 
-#define PYUV_SLAB_SIZE 65536
+#define PYUV_BUFFER_SIZE 65536
+#define PYUV_BUFFER_POOL_DEPTH 16
+
+/* Stream.pipe_to stops reading when the destination has this many bytes queued */
+#define PYUV_PROXY_HIGH_WATERMARK (4 * PYUV_BUFFER_SIZE)
+
+#define PYUV_REQ_CACHE_DEPTH 64
+/* Contexts which stay unused for this long are released back to the allocator */
+#define PYUV_REQ_CACHE_IDLE_MS 5000
+
+/* Stream read framing modes */
+#define PYUV_FRAMING_NONE      0
+#define PYUV_FRAMING_DELIMITER 1
+#define PYUV_FRAMING_LENGTH    2
+
+/* Returned by pyuv__gil_ensure when the running loop already owns the GIL */
+#define PYUV_GIL_LOOP_OWNED -1
 
 
 /* Custom pyuv handle flags */
@@ -171,8 +193,47 @@ typedef int Bool;
 #define IS_PYUV_HANDLE(ptr) (ptr && ((Handle*)ptr)->handle_magic == PYUV_HANDLE_MAGIC)
 #define PYUV_HANDLE_MAGIC &HandleType
 
+/* Read buffers are kept in a per-loop pool, the payload follows the header */
+typedef struct pyuv_buffer_s {
+    struct pyuv_buffer_s *next;
+    size_t size;
+} pyuv_buffer_t;
+
+#define PYUV_BUFFER_DATA(b) ((char *)(b) + sizeof(pyuv_buffer_t))
+#define PYUV_BUFFER_HEADER(p) ((pyuv_buffer_t *)((char *)(p) - sizeof(pyuv_buffer_t)))
+
+/* Request contexts (writes, shutdowns, UDP sends) are recycled through per-loop free
+ * lists, one for each kind of context. Unused contexts are linked through their first bytes. */
+typedef struct pyuv_req_cache_s {
+    void *free_list;
+    unsigned int free_count;
+    unsigned int min_free;
+} pyuv_req_cache_t;
+
+
+/* Write queue watermarks, used for flow control on streams and UDP handles */
+typedef struct {
+    size_t high;
+    size_t low;
+    PyObject *on_pause;
+    PyObject *on_resume;
+    Bool paused;
+} pyuv_watermarks_t;
+
+
+/* io_uring state for a loop, defined in uring.c */
+typedef struct pyuv_uring_s pyuv_uring_t;
+
+
 /* Python types definitions */
 
+/* Address: a tuple subclass holding the parsed socket address after the items, usable
+ * wherever an address tuple is expected */
+#define PYUV_ADDRESS_SOCKADDR(obj)                                                       \
+    ((struct sockaddr_storage *)((char *)((PyTupleObject *)(obj))->ob_item + Py_SIZE(obj) * sizeof(PyObject *)))
+
+static PyTypeObject AddressType;
+
 /* Loop */
 typedef struct {
     PyObject_HEAD
@@ -182,9 +243,47 @@ typedef struct {
     uv_loop_t *uv_loop;
     int is_default;
     struct {
-        char slab[PYUV_SLAB_SIZE];
-        Bool in_use;
+        pyuv_buffer_t *free_list;
+        size_t size;
+        unsigned int depth;
+        unsigned int free_count;
+        unsigned int in_use;
+        size_t memory;
+        unsigned PY_LONG_LONG hits;
+        unsigned PY_LONG_LONG misses;
     } buffer;
+    struct {
+        pyuv_req_cache_t write;
+        pyuv_req_cache_t shutdown;
+        pyuv_req_cache_t udp_send;
+        pyuv_req_cache_t proxy_write;
+        unsigned int depth;
+        unsigned int in_use;
+        uv_timer_t trim_timer;
+        Bool timer_initialized;
+        unsigned PY_LONG_LONG hits;
+        unsigned PY_LONG_LONG misses;
+        unsigned PY_LONG_LONG trimmed;
+    } reqs;
+    struct {
+        uv_idle_t idle_h;
+        uv_write_t *head;
+        uv_write_t *tail;
+        Bool initialized;
+    } deferred;
+    struct {
+        uv_prepare_t prepare_h;
+        PyObject *streams;
+        Bool initialized;
+    } coalesce;
+    struct {
+        uv_prepare_t prepare_h;
+        PyThreadState *tstate;
+        Bool hold;
+        Bool active;
+        Bool prepare_started;
+    } gil;
+    pyuv_uring_t *uring;
 } Loop;
 
 static PyTypeObject LoopType;
@@ -267,14 +366,67 @@ typedef struct {
 
 static PyTypeObject SignalCheckerType;
 
+/* ReadBuffer: exports a pooled read buffer as a read-only memoryview */
+typedef struct {
+    PyObject_HEAD
+    char *base;
+    Py_ssize_t len;
+    int exports;
+    Bool detached;
+} ReadBuffer;
+
+static PyTypeObject ReadBufferType;
+
 /* Stream */
 typedef struct {
     Handle handle;
     PyObject *on_read_cb;
+    Bool read_zero_copy;
+    ReadBuffer *read_buffer;
+    PyObject *read_into;
+    Py_buffer read_into_view;
+    Bool eager_write;
+    pyuv_watermarks_t watermarks;
+    struct {
+        int mode;
+        PyObject *delimiter;
+        int prefix_size;
+        Bool little_endian;
+        size_t max_size;
+        Bool batch;
+        char *buf;
+        size_t len;
+        size_t size;
+        size_t scanned;
+        unsigned int generation;
+    } framing;
+    struct {
+        PyObject *dest;
+        PyObject *callback;
+        size_t high;
+        unsigned PY_LONG_LONG bytes_read;
+        unsigned PY_LONG_LONG bytes_written;
+        unsigned int pending;
+        Bool active;
+        Bool paused;
+        Bool eof;
+    } proxy;
+    Bool corked;
+    Bool coalesce_writes;
+    struct {
+        struct stream_write_ctx_s *head;
+        struct stream_write_ctx_s *tail;
+        unsigned int nbufs;
+        size_t size;
+        Bool scheduled;
+    } buffered;
 } Stream;
 
 static PyTypeObject StreamType;
 
+/* Used by Handle.close, defined in stream.c */
+static void pyuv__stream_flush_writes(Stream *self);
+
 /* TCP */
 typedef struct {
     Stream stream;
@@ -302,10 +454,22 @@ typedef struct {
 static PyTypeObject TTYType;
 
 /* UDP */
+#define PYUV_UDP_PEER_CACHE_SIZE 16
+
 typedef struct {
     Handle handle;
     uv_udp_t udp_h;
     PyObject *on_read_cb;
+    pyuv_watermarks_t watermarks;
+    struct {
+        Py_ssize_t max;
+        PyObject *datagrams;
+    } batch;
+    Bool gro;
+    PyObject *peers[PYUV_UDP_PEER_CACHE_SIZE];
+    Bool connected;
+    struct sockaddr_storage peer;
+    PyObject *peer_address;
 } UDP;
 
 static PyTypeObject UDPType;
@@ -357,6 +521,54 @@ typedef struct {
 
 static PyTypeObject FSPollType;
 
+/* AsyncFileWriter */
+typedef struct fs_writer_record_s fs_writer_record;
+
+typedef struct {
+    PyObject_HEAD
+    Bool initialized;
+    Bool busy;
+    Bool datasync;
+    Loop *loop;
+    uv_work_t work_req;
+    uv_file fd;
+    size_t max_batch_size;
+    fs_writer_record *pending_head;
+    fs_writer_record *pending_tail;
+    fs_writer_record *batch;
+    uv_buf_t *bufs;
+    unsigned int nbufs;
+    int batch_result;
+    uint64_t batch_start;
+    Py_ssize_t count;
+    struct {
+        unsigned PY_LONG_LONG batches;
+        unsigned PY_LONG_LONG records;
+        unsigned PY_LONG_LONG bytes;
+        Py_ssize_t last_batch_records;
+        Py_ssize_t max_batch_records;
+        size_t last_batch_bytes;
+        uint64_t last_latency;
+        uint64_t max_latency;
+        uint64_t total_latency;
+    } stats;
+} AsyncFileWriter;
+
+static PyTypeObject AsyncFileWriterType;
+
+/* MMap */
+typedef struct {
+    PyObject_HEAD
+    Loop *loop;
+    char *map;
+    size_t map_len;
+    char *base;
+    Py_ssize_t len;
+    Py_ssize_t exports;
+} MMap;
+
+static PyTypeObject MMapType;
+
 /* Barrier */
 typedef struct {
     PyObject_HEAD
@@ -453,10 +665,34 @@ typedef struct {
     Py_buffer view;
     /* for read requests */
     uv_buf_t buf;
+    /* for readinto / writev requests */
+    Py_buffer *views;
+    Py_ssize_t view_count;
+    /* for read_file / write_file / copyfile requests */
+    uv_work_t work_req;
+    struct {
+        uv_fs_type type;
+        char *path;
+        char *new_path;
+        int flags;
+        int mode;
+        Bool fsync;
+        Bool atomic;
+        char *data;
+        size_t len;
+        ssize_t result;
+    } file;
 } FSRequest;
 
 static PyTypeObject FSRequestType;
 
+/* io_uring fs backend, defined in uring.c */
+static int pyuv__uring_enable(Loop *loop);
+static void pyuv__uring_disable(Loop *loop);
+static Bool pyuv__uring_enabled(Loop *loop);
+static int pyuv__uring_close(Loop *loop);
+static int pyuv__uring_submit(Loop *loop, FSRequest *fs_req, uv_fs_type type, uv_file fd, const char *path, int flags, int mode, const uv_buf_t *bufs, unsigned int nbufs, int64_t offset);
+
 
 /* Exceptions */
 static PyObject* PyExc_AsyncError;
@@ -503,6 +739,65 @@ static PyStructSequence_Desc addrinfo_result_desc = {
 };
 
 
+/* used by Loop.buffer_stats */
+static PyTypeObject BufferStatsResultType;
+
+static PyStructSequence_Field buffer_stats_result_fields[] = {
+    {"memory", "bytes allocated for read buffers"},
+    {"in_use", "buffers currently handed out"},
+    {"free", "buffers kept in the pool"},
+    {"hits", "allocations served from the pool"},
+    {"misses", "allocations which had to allocate memory"},
+    {NULL}
+};
+
+static PyStructSequence_Desc buffer_stats_result_desc = {
+    "buffer_stats_result",
+    NULL,
+    buffer_stats_result_fields,
+    5
+};
+
+
+/* used by Loop.request_cache_stats */
+static PyTypeObject RequestCacheStatsResultType;
+
+static PyStructSequence_Field request_cache_stats_result_fields[] = {
+    {"in_use", "request contexts currently in flight"},
+    {"free", "request contexts kept in the cache"},
+    {"hits", "allocations served from the cache"},
+    {"misses", "allocations which had to allocate memory"},
+    {"trimmed", "cached contexts released after being idle"},
+    {NULL}
+};
+
+static PyStructSequence_Desc request_cache_stats_result_desc = {
+    "request_cache_stats_result",
+    NULL,
+    request_cache_stats_result_fields,
+    5
+};
+
+
+/* used by Stream.pipe_stats */
+static PyTypeObject PipeStatsResultType;
+
+static PyStructSequence_Field pipe_stats_result_fields[] = {
+    {"bytes_read", "bytes read from the source stream"},
+    {"bytes_written", "bytes written to the destination stream"},
+    {"pending", "write requests in flight"},
+    {"paused", "reading is paused because the destination is not keeping up"},
+    {NULL}
+};
+
+static PyStructSequence_Desc pipe_stats_result_desc = {
+    "pipe_stats_result",
+    NULL,
+    pipe_stats_result_fields,
+    4
+};
+
+
 /* used by fs stat functions */
 static PyTypeObject StatResultType;
 
@@ -551,6 +846,48 @@ static PyStructSequence_Desc dirent_desc = {
 };
 
 
+/* used by walk */
+static PyTypeObject WalkEntryType;
+
+static PyStructSequence_Field walk_entry_fields[] = {
+    {"name", ""},
+    {"type", ""},
+    {"stat", ""},
+    {NULL}
+};
+
+static PyStructSequence_Desc walk_entry_desc = {
+    "WalkEntry",
+    NULL,
+    walk_entry_fields,
+    3
+};
+
+
+/* used by AsyncFileWriter */
+static PyTypeObject AsyncFileWriterStatsType;
+
+static PyStructSequence_Field writer_stats_fields[] = {
+    {"batches", ""},
+    {"records", ""},
+    {"bytes", ""},
+    {"last_batch_records", ""},
+    {"last_batch_bytes", ""},
+    {"max_batch_records", ""},
+    {"last_latency", ""},
+    {"max_latency", ""},
+    {"avg_latency", ""},
+    {NULL}
+};
+
+static PyStructSequence_Desc writer_stats_desc = {
+    "AsyncFileWriterStats",
+    NULL,
+    writer_stats_fields,
+    9
+};
+
+
 /* used by interface_addresses */
 static PyTypeObject InterfaceAddressesResultType;
 
@@ -2,7 +2,7 @@
 static void
 pyuv__signal_cb(uv_signal_t *handle, int signum)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Signal *self;
     PyObject *result;
 
@@ -20,7 +20,7 @@ pyuv__signal_cb(uv_signal_t *handle, int signum)
     Py_XDECREF(result);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -1,5 +1,5 @@
 
-typedef struct {
+typedef struct stream_write_ctx_s {
     uv_write_t req;
     Stream *obj;
     PyObject *callback;
@@ -7,6 +7,7 @@ typedef struct {
     Py_buffer *views;
     Py_buffer viewsml[4];
     int view_count;
+    struct stream_write_ctx_s *next;
 } stream_write_ctx;
 
 
@@ -17,11 +18,127 @@ typedef struct {
 } stream_shutdown_ctx;
 
 
+typedef struct {
+    uv_write_t req;
+    Stream *source;
+    char *base;
+    size_t len;
+} stream_proxy_write_ctx;
+
+
+static int
+ReadBuffer_tp_getbuffer(ReadBuffer *self, Py_buffer *view, int flags)
+{
+    if (self->base == NULL) {
+        PyErr_SetString(PyExc_ValueError, "read buffer was already released");
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->base, self->len, 1, flags) < 0) {
+        return -1;
+    }
+    self->exports++;
+    return 0;
+}
+
+
+static void
+ReadBuffer_tp_releasebuffer(ReadBuffer *self, Py_buffer *view)
+{
+    UNUSED_ARG(view);
+
+    self->exports--;
+    if (self->exports == 0 && self->detached) {
+        /* The application kept the data past the read callback, the buffer is ours now */
+        pyuv__buffer_free(self->base);
+        self->base = NULL;
+        self->detached = False;
+    }
+}
+
+
+static void
+ReadBuffer_tp_dealloc(ReadBuffer *self)
+{
+    if (self->base != NULL && self->detached) {
+        pyuv__buffer_free(self->base);
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+static PyBufferProcs ReadBuffer_tp_as_buffer = {
+#ifndef PYUV_PYTHON3
+    0,                                                             /*bf_getreadbuffer*/
+    0,                                                             /*bf_getwritebuffer*/
+    0,                                                             /*bf_getsegcount*/
+    0,                                                             /*bf_getcharbuffer*/
+#endif
+    (getbufferproc)ReadBuffer_tp_getbuffer,                        /*bf_getbuffer*/
+    (releasebufferproc)ReadBuffer_tp_releasebuffer,                /*bf_releasebuffer*/
+};
+
+
+static PyTypeObject ReadBufferType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyuv._cpyuv.ReadBuffer",                                      /*tp_name*/
+    sizeof(ReadBuffer),                                            /*tp_basicsize*/
+    0,                                                             /*tp_itemsize*/
+    (destructor)ReadBuffer_tp_dealloc,                             /*tp_dealloc*/
+    0,                                                             /*tp_print*/
+    0,                                                             /*tp_getattr*/
+    0,                                                             /*tp_setattr*/
+    0,                                                             /*tp_compare*/
+    0,                                                             /*tp_repr*/
+    0,                                                             /*tp_as_number*/
+    0,                                                             /*tp_as_sequence*/
+    0,                                                             /*tp_as_mapping*/
+    0,                                                             /*tp_hash */
+    0,                                                             /*tp_call*/
+    0,                                                             /*tp_str*/
+    0,                                                             /*tp_getattro*/
+    0,                                                             /*tp_setattro*/
+    &ReadBuffer_tp_as_buffer,                                      /*tp_as_buffer*/
+#ifdef PYUV_PYTHON3
+    Py_TPFLAGS_DEFAULT,                                            /*tp_flags*/
+#else
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER,                /*tp_flags*/
+#endif
+    0,                                                             /*tp_doc*/
+};
+
+
+/* Wrap a pooled read buffer in a memoryview. The ReadBuffer object is cached in the
+ * stream and reused as long as the application didn't keep the previous data around. */
+static PyObject *
+pyuv__stream_lease_buffer(Stream *self, char *base, Py_ssize_t len)
+{
+    ReadBuffer *rbuf;
+
+    rbuf = self->read_buffer;
+    if (rbuf == NULL || Py_REFCNT(rbuf) > 1) {
+        rbuf = PyObject_New(ReadBuffer, &ReadBufferType);
+        if (rbuf == NULL) {
+            return NULL;
+        }
+        rbuf->exports = 0;
+        Py_XDECREF(self->read_buffer);
+        self->read_buffer = rbuf;
+    }
+
+    rbuf->base = base;
+    rbuf->len = len;
+    rbuf->detached = False;
+
+    return PyMemoryView_FromObject((PyObject *)rbuf);
+}
+
+
 static void
 pyuv__stream_shutdown_cb(uv_shutdown_t* req, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->handle->loop);
     stream_shutdown_ctx *ctx;
+    Loop *loop;
     Stream *self;
     PyObject *callback, *result, *py_errorno;
 
@@ -45,21 +162,240 @@ pyuv__stream_shutdown_cb(uv_shutdown_t* req, int status)
     }
 
     Py_DECREF(callback);
-    PyMem_Free(req);
+    loop = req->handle->loop->data;
+    pyuv__req_put(loop, &loop->reqs.shutdown, ctx);
 
     /* Refcount was increased in the caller function */
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
+}
+
+
+/* Find the first occurrence of needle in haystack */
+static const char *
+pyuv__memsearch(const char *haystack, size_t n, const char *needle, size_t m)
+{
+    const char *p, *end;
+
+    if (m == 0 || n < m) {
+        return NULL;
+    }
+
+    end = haystack + n - m + 1;
+    for (p = haystack; p < end; p++) {
+        p = memchr(p, needle[0], end - p);
+        if (p == NULL) {
+            return NULL;
+        }
+        if (memcmp(p, needle, m) == 0) {
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+
+/* Drop any partially received frame */
+static void
+pyuv__stream_framing_reset(Stream *self)
+{
+    self->framing.len = 0;
+    self->framing.scanned = 0;
+    self->framing.generation++;
+}
+
+
+static int
+pyuv__stream_framing_append(Stream *self, const char *data, size_t len)
+{
+    char *tmp;
+    size_t size;
+
+    if (self->framing.size - self->framing.len < len) {
+        size = self->framing.size ? self->framing.size : 256;
+        while (size - self->framing.len < len) {
+            size *= 2;
+        }
+        tmp = PyMem_Realloc(self->framing.buf, size);
+        if (tmp == NULL) {
+            return UV_ENOMEM;
+        }
+        self->framing.buf = tmp;
+        self->framing.size = size;
+    }
+
+    memcpy(self->framing.buf + self->framing.len, data, len);
+    self->framing.len += len;
+    return 0;
+}
+
+
+/* Frames are delivered one by one to the read callback, or collected in a list */
+static void
+pyuv__stream_emit_frame(Stream *self, PyObject *frames, const char *data, size_t len)
+{
+    PyObject *frame, *result;
+
+    frame = PyBytes_FromStringAndSize(data, len);
+    if (frame == NULL) {
+        handle_uncaught_exception(HANDLE(self)->loop);
+        return;
+    }
+
+    if (frames != NULL) {
+        if (PyList_Append(frames, frame) < 0) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+        }
+    } else {
+        result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, frame, Py_None, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+        }
+        Py_XDECREF(result);
+    }
+
+    Py_DECREF(frame);
+}
+
+
+/* Deliver all complete frames contained in data. The number of bytes which were consumed
+ * is stored in 'consumed'. Parsing stops early if reading is stopped or reconfigured by
+ * a callback. */
+static int
+pyuv__stream_parse_frames(Stream *self, const char *data, size_t len, PyObject *frames, size_t *consumed)
+{
+    const char *delimiter, *found;
+    size_t pos, rest, dlen, flen;
+    unsigned PY_LONG_LONG frame_len;
+    unsigned int generation;
+    int i, prefix;
+
+    pos = 0;
+    generation = self->framing.generation;
+
+    while (self->on_read_cb != NULL && self->framing.generation == generation && !uv_is_closing(UV_HANDLE(self))) {
+        rest = len - pos;
+        if (self->framing.mode == PYUV_FRAMING_DELIMITER) {
+            delimiter = PyBytes_AS_STRING(self->framing.delimiter);
+            dlen = PyBytes_GET_SIZE(self->framing.delimiter);
+            found = pyuv__memsearch(data + pos + self->framing.scanned, rest - self->framing.scanned, delimiter, dlen);
+            if (found == NULL) {
+                /* The end of the data could be the beginning of a delimiter */
+                if (self->framing.max_size && rest > self->framing.max_size + dlen - 1) {
+                    *consumed = pos;
+                    return UV_EMSGSIZE;
+                }
+                self->framing.scanned = rest >= dlen ? rest - dlen + 1 : 0;
+                break;
+            }
+            flen = found - (data + pos);
+            if (self->framing.max_size && flen > self->framing.max_size) {
+                *consumed = pos;
+                return UV_EMSGSIZE;
+            }
+            self->framing.scanned = 0;
+            pyuv__stream_emit_frame(self, frames, data + pos, flen);
+            pos += flen + dlen;
+        } else {
+            prefix = self->framing.prefix_size;
+            if (rest < (size_t)prefix) {
+                break;
+            }
+            frame_len = 0;
+            for (i = 0; i < prefix; i++) {
+                if (self->framing.little_endian) {
+                    frame_len |= (unsigned PY_LONG_LONG)(unsigned char)data[pos + i] << (8 * i);
+                } else {
+                    frame_len = (frame_len << 8) | (unsigned char)data[pos + i];
+                }
+            }
+            if ((self->framing.max_size && frame_len > self->framing.max_size) || frame_len > (unsigned PY_LONG_LONG)(PY_SSIZE_T_MAX - prefix)) {
+                *consumed = pos;
+                return UV_EMSGSIZE;
+            }
+            if (rest - prefix < frame_len) {
+                break;
+            }
+            pyuv__stream_emit_frame(self, frames, data + pos + prefix, (size_t)frame_len);
+            pos += prefix + (size_t)frame_len;
+        }
+    }
+
+    *consumed = pos;
+    return 0;
+}
+
+
+static void
+pyuv__stream_read_frames(Stream *self, const char *data, size_t len)
+{
+    int err;
+    unsigned int generation;
+    size_t consumed;
+    PyObject *frames, *result, *py_errorno;
+
+    frames = NULL;
+    if (self->framing.batch) {
+        frames = PyList_New(0);
+        if (frames == NULL) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+            return;
+        }
+    }
+
+    generation = self->framing.generation;
+
+    if (self->framing.len == 0) {
+        /* Parse straight from the read buffer, only a partial frame is copied */
+        err = pyuv__stream_parse_frames(self, data, len, frames, &consumed);
+        if (err == 0 && self->framing.generation == generation && consumed < len) {
+            err = pyuv__stream_framing_append(self, data + consumed, len - consumed);
+        }
+    } else {
+        err = pyuv__stream_framing_append(self, data, len);
+        if (err == 0) {
+            err = pyuv__stream_parse_frames(self, self->framing.buf, self->framing.len, frames, &consumed);
+            if (self->framing.generation == generation && consumed > 0) {
+                memmove(self->framing.buf, self->framing.buf + consumed, self->framing.len - consumed);
+                self->framing.len -= consumed;
+            }
+        }
+    }
+
+    if (frames != NULL) {
+        if (PyList_GET_SIZE(frames) > 0 && self->on_read_cb != NULL) {
+            result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, frames, Py_None, NULL);
+            if (result == NULL) {
+                handle_uncaught_exception(HANDLE(self)->loop);
+            }
+            Py_XDECREF(result);
+        }
+        Py_DECREF(frames);
+    }
+
+    if (err < 0 && self->on_read_cb != NULL) {
+        pyuv__stream_framing_reset(self);
+        uv_read_stop((uv_stream_t *)UV_HANDLE(self));
+        py_errorno = PyInt_FromLong((long)err);
+        result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, Py_None, py_errorno, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+        }
+        Py_XDECREF(result);
+        Py_XDECREF(py_errorno);
+    }
 }
 
 
 static void
 pyuv__stream_read_cb(uv_stream_t* handle, int nread, const uv_buf_t* buf)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Loop *loop;
     Stream *self;
+    Bool leased;
     PyObject *result, *data, *py_errorno;
     ASSERT(handle);
 
@@ -69,8 +405,28 @@ pyuv__stream_read_cb(uv_stream_t* handle, int nread, const uv_buf_t* buf)
     /* Object could go out of scope in the callback, increase refcount to avoid it */
     Py_INCREF(self);
 
+    leased = False;
+
+    if (nread >= 0 && self->framing.mode != PYUV_FRAMING_NONE) {
+        if (nread > 0) {
+            pyuv__stream_read_frames(self, buf->base, nread);
+        }
+        goto done;
+    }
+
     if (nread >= 0) {
-        data = PyBytes_FromStringAndSize(buf->base, nread);
+        data = NULL;
+        if (self->read_zero_copy) {
+            data = pyuv__stream_lease_buffer(self, buf->base, nread);
+            if (data == NULL) {
+                PyErr_Clear();
+            } else {
+                leased = True;
+            }
+        }
+        if (data == NULL) {
+            data = PyBytes_FromStringAndSize(buf->base, nread);
+        }
         py_errorno = Py_None;
         Py_INCREF(Py_None);
     } else {
@@ -89,28 +445,132 @@ pyuv__stream_read_cb(uv_stream_t* handle, int nread, const uv_buf_t* buf)
     Py_DECREF(data);
     Py_DECREF(py_errorno);
 
-    /* data has been read, unlock the buffer */
+done:
+    /* data has been read, return the buffer to the pool */
     loop = handle->loop->data;
     ASSERT(loop);
-    loop->buffer.in_use = False;
+    if (leased && self->read_buffer->exports > 0) {
+        /* The memoryview outlived the callback, it now owns the buffer */
+        pyuv__buffer_detach(loop, buf->base);
+        self->read_buffer->detached = True;
+    } else {
+        if (leased) {
+            self->read_buffer->base = NULL;
+        }
+        pyuv__buffer_put(loop, buf->base);
+    }
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
 static void
-pyuv__stream_write_cb(uv_write_t* req, int status)
+pyuv__stream_alloc_into_cb(uv_handle_t* handle, size_t suggested_size, uv_buf_t *buf)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    Stream *self;
+    PyObject *obj;
+
+    ASSERT(handle);
+    UNUSED_ARG(suggested_size);
+
+    /* Can't use container_of here */
+    self = (Stream *)handle->data;
+
+    buf->base = NULL;
+    buf->len = 0;
+
+    if (PyObject_CheckBuffer(self->read_into)) {
+        obj = self->read_into;
+        Py_INCREF(obj);
+    } else {
+        obj = PyObject_CallFunctionObjArgs(self->read_into, self, NULL);
+        if (obj == NULL) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+            goto done;
+        }
+    }
+
+    /* A zero-length buffer makes libuv report UV_ENOBUFS to the read callback */
+    if (PyObject_GetBuffer(obj, &self->read_into_view, PyBUF_WRITABLE) != 0) {
+        handle_uncaught_exception(HANDLE(self)->loop);
+    } else {
+        buf->base = self->read_into_view.buf;
+        buf->len = self->read_into_view.len;
+    }
+    Py_DECREF(obj);
+
+done:
+    pyuv__gil_release(gstate);
+}
+
+
+static void
+pyuv__stream_read_into_cb(uv_stream_t* handle, int nread, const uv_buf_t* buf)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    Stream *self;
+    PyObject *result, *py_nread, *py_errorno;
+    ASSERT(handle);
+
+    /* Can't use container_of here */
+    self = (Stream *)handle->data;
+
+    /* Object could go out of scope in the callback, increase refcount to avoid it */
+    Py_INCREF(self);
+
+    /* The data is already in the application's buffer, let go of it */
+    if (buf->base != NULL && self->read_into_view.obj != NULL) {
+        PyBuffer_Release(&self->read_into_view);
+    }
+
+    if (nread == 0) {
+        /* libuv got EAGAIN, nothing was read */
+        goto done;
+    }
+
+    if (nread > 0) {
+        py_nread = PyInt_FromLong((long)nread);
+        py_errorno = Py_None;
+        Py_INCREF(Py_None);
+    } else {
+        py_nread = Py_None;
+        Py_INCREF(Py_None);
+        py_errorno = PyInt_FromLong((long)nread);
+        /* Stop reading, otherwise an assert blows up on unix */
+        uv_read_stop(handle);
+    }
+
+    result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, py_nread, py_errorno, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(HANDLE(self)->loop);
+    }
+    Py_XDECREF(result);
+    Py_DECREF(py_nread);
+    Py_DECREF(py_errorno);
+
+done:
+    Py_DECREF(self);
+    pyuv__gil_release(gstate);
+}
+
+
+/* Data waiting to be written, including buffered writes */
+static INLINE size_t
+pyuv__stream_write_queue_size(Stream *self)
+{
+    return ((uv_stream_t *)UV_HANDLE(self))->write_queue_size + self->buffered.size;
+}
+
+
+static void
+pyuv__stream_write_complete(Loop *loop, stream_write_ctx *ctx, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
     int i;
-    stream_write_ctx *ctx;
     Stream *self;
     PyObject *callback, *send_handle, *result, *py_errorno;
 
-    ASSERT(req);
-
-    ctx = PYUV_CONTAINER_OF(req, stream_write_ctx, req);
     self = ctx->obj;
     callback = ctx->callback;
     send_handle = ctx->send_handle;
@@ -124,7 +584,7 @@ pyuv__stream_write_cb(uv_write_t* req, int status)
         }
         result = PyObject_CallFunctionObjArgs(callback, self, py_errorno, NULL);
         if (result == NULL) {
-            handle_uncaught_exception(HANDLE(self)->loop);
+            handle_uncaught_exception(loop);
         }
         Py_XDECREF(result);
         Py_DECREF(py_errorno);
@@ -137,12 +597,219 @@ pyuv__stream_write_cb(uv_write_t* req, int status)
         PyBuffer_Release(&ctx->views[i]);
     if (ctx->views != ctx->viewsml)
         PyMem_Free(ctx->views);
-    PyMem_Free(ctx);
+    pyuv__req_put(loop, &loop->reqs.write, ctx);
 
     /* Refcount was increased in the caller function */
     Py_DECREF(self);
+}
+
+
+static void
+pyuv__stream_write_cb(uv_write_t* req, int status)
+{
+    int gstate = pyuv__gil_ensure(req->handle->loop);
+    stream_write_ctx *ctx, *next;
+    Loop *loop;
+    Stream *self;
+
+    ASSERT(req);
+
+    ctx = PYUV_CONTAINER_OF(req, stream_write_ctx, req);
+    loop = req->handle->loop->data;
+    self = ctx->obj;
+
+    /* Object could go out of scope in the callbacks, increase refcount to avoid it */
+    Py_INCREF(self);
+
+    /* Coalesced writes are chained to the context whose request was submitted */
+    while (ctx != NULL) {
+        next = ctx->next;
+        pyuv__stream_write_complete(loop, ctx, status);
+        ctx = next;
+    }
+
+    if (!uv_is_closing(UV_HANDLE(self))) {
+        pyuv__watermarks_update(&self->watermarks, (PyObject *)self, loop, pyuv__stream_write_queue_size(self));
+    }
+
+    Py_DECREF(self);
+
+    pyuv__gil_release(gstate);
+}
+
+
+/* Stop forwarding data, the callback is not called */
+static void
+pyuv__stream_proxy_clear(Stream *self)
+{
+    self->proxy.active = False;
+    self->proxy.paused = False;
+    self->proxy.eof = False;
+    Py_CLEAR(self->proxy.dest);
+    Py_CLEAR(self->proxy.callback);
+}
+
+
+/* Forwarding is over, because of an error or because the source reached EOF and everything
+ * was written */
+static void
+pyuv__stream_proxy_finish(Stream *self, int status)
+{
+    PyObject *callback, *result, *py_errorno;
+
+    if (!self->proxy.active) {
+        return;
+    }
+
+    uv_read_stop((uv_stream_t *)UV_HANDLE(self));
+
+    callback = self->proxy.callback;
+    self->proxy.callback = NULL;
+    pyuv__stream_proxy_clear(self);
+
+    if (callback != NULL && callback != Py_None) {
+        if (status < 0) {
+            py_errorno = PyInt_FromLong((long)status);
+        } else {
+            py_errorno = Py_None;
+            Py_INCREF(Py_None);
+        }
+        result = PyObject_CallFunctionObjArgs(callback, self, py_errorno, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+        }
+        Py_XDECREF(result);
+        Py_DECREF(py_errorno);
+    }
+    Py_XDECREF(callback);
+
+    PYUV_HANDLE_DECREF(self);
+}
+
+
+static void pyuv__stream_proxy_read_cb(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf);
+
+static void
+pyuv__stream_proxy_write_cb(uv_write_t* req, int status)
+{
+    int gstate = pyuv__gil_ensure(req->handle->loop);
+    int err;
+    stream_proxy_write_ctx *ctx;
+    Stream *self;
+    Loop *loop;
+
+    ctx = PYUV_CONTAINER_OF(req, stream_proxy_write_ctx, req);
+    self = ctx->source;
+    loop = req->handle->loop->data;
+
+    /* The data was written straight from the read buffer */
+    pyuv__buffer_put(loop, ctx->base);
+
+    self->proxy.pending--;
+    if (status == 0) {
+        self->proxy.bytes_written += ctx->len;
+    }
+    pyuv__req_put(loop, &loop->reqs.proxy_write, ctx);
+
+    if (self->proxy.active) {
+        if (status < 0) {
+            pyuv__stream_proxy_finish(self, status);
+        } else if (self->proxy.eof) {
+            if (self->proxy.pending == 0) {
+                pyuv__stream_proxy_finish(self, 0);
+            }
+        } else if (self->proxy.paused &&
+                   (self->proxy.pending == 0 || ((uv_stream_t *)req->handle)->write_queue_size <= self->proxy.high / 2)) {
+            /* Writes queued on dest by other code may keep it above the threshold, once all of our
+             * own writes are done there is nothing left that would resume reading later */
+            err = uv_read_start((uv_stream_t *)UV_HANDLE(self), (uv_alloc_cb)pyuv__alloc_cb, (uv_read_cb)pyuv__stream_proxy_read_cb);
+            if (err < 0) {
+                pyuv__stream_proxy_finish(self, err);
+            } else {
+                self->proxy.paused = False;
+            }
+        }
+    }
+
+    /* Refcount was increased in the read callback */
+    Py_DECREF(self);
+
+    pyuv__gil_release(gstate);
+}
+
+
+static void
+pyuv__stream_proxy_read_cb(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    int err;
+    uv_buf_t wbuf;
+    stream_proxy_write_ctx *ctx;
+    Stream *self, *dest;
+    Loop *loop;
+
+    /* Can't use container_of here */
+    self = (Stream *)handle->data;
+    loop = handle->loop->data;
+
+    /* Object could go out of scope in the callback, increase refcount to avoid it */
+    Py_INCREF(self);
+
+    if (nread > 0 && self->proxy.active) {
+        dest = (Stream *)self->proxy.dest;
+        self->proxy.bytes_read += nread;
+
+        ctx = pyuv__req_get(loop, &loop->reqs.proxy_write, sizeof *ctx);
+        if (ctx == NULL) {
+            PyErr_Clear();
+            pyuv__buffer_put(loop, buf->base);
+            pyuv__stream_proxy_finish(self, UV_ENOMEM);
+            goto done;
+        }
+        ctx->source = self;
+        ctx->base = buf->base;
+        ctx->len = (size_t)nread;
+
+        /* Writes which were buffered on the destination go first */
+        pyuv__stream_flush_writes(dest);
+
+        wbuf = uv_buf_init(buf->base, (unsigned int)nread);
+        err = uv_write(&ctx->req, (uv_stream_t *)UV_HANDLE(dest), &wbuf, 1, pyuv__stream_proxy_write_cb);
+        if (err < 0) {
+            pyuv__req_put(loop, &loop->reqs.proxy_write, ctx);
+            pyuv__buffer_put(loop, buf->base);
+            pyuv__stream_proxy_finish(self, err);
+            goto done;
+        }
+
+        /* The write context holds a reference until the data is written */
+        Py_INCREF(self);
+        self->proxy.pending++;
+
+        if (((uv_stream_t *)UV_HANDLE(dest))->write_queue_size > self->proxy.high) {
+            uv_read_stop(handle);
+            self->proxy.paused = True;
+        }
+        goto done;
+    }
+
+    pyuv__buffer_put(loop, buf->base);
+
+    if (nread < 0) {
+        uv_read_stop(handle);
+        if (nread == UV_EOF) {
+            self->proxy.eof = True;
+            if (self->proxy.pending == 0) {
+                pyuv__stream_proxy_finish(self, 0);
+            }
+        } else {
+            pyuv__stream_proxy_finish(self, (int)nread);
+        }
+    }
 
-    PyGILState_Release(gstate);
+done:
+    Py_DECREF(self);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -163,9 +830,8 @@ Stream_func_shutdown(Stream *self, PyObject *args)
         return NULL;
     }
 
-    ctx = PyMem_Malloc(sizeof *ctx);
+    ctx = pyuv__req_get(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.shutdown, sizeof *ctx);
     if (!ctx) {
-        PyErr_NoMemory();
         return NULL;
     }
 
@@ -174,45 +840,171 @@ Stream_func_shutdown(Stream *self, PyObject *args)
     ctx->obj = self;
     ctx->callback = callback;
 
+    pyuv__stream_flush_writes(self);
+
     err = uv_shutdown(&ctx->req, (uv_stream_t *)UV_HANDLE(self), pyuv__stream_shutdown_cb);
     if (err < 0) {
         RAISE_STREAM_EXCEPTION(err, UV_HANDLE(self));
         goto error;
     }
 
-    /* Increase refcount so that object is not removed before the callback is called */
-    Py_INCREF(self);
+    /* Increase refcount so that object is not removed before the callback is called */
+    Py_INCREF(self);
+
+    Py_RETURN_NONE;
+
+error:
+    Py_DECREF(callback);
+    pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.shutdown, ctx);
+    return NULL;
+}
+
+
+static PyObject *
+Stream_func_start_read(Stream *self, PyObject *args, PyObject *kwargs)
+{
+    int err, mode, length_prefix;
+    char *byteorder;
+    Bool little_endian;
+    Py_ssize_t max_frame_size;
+    PyObject *tmp, *callback, *zero_copy, *delimiter, *batch;
+
+    static char *kwlist[] = {"callback", "zero_copy", "delimiter", "length_prefix", "byteorder", "max_frame_size", "batch", NULL};
+
+    tmp = NULL;
+    zero_copy = Py_False;
+    delimiter = Py_None;
+    length_prefix = 0;
+    byteorder = "big";
+    max_frame_size = 0;
+    batch = Py_False;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O!OisnO!:start_read", kwlist, &callback, &PyBool_Type, &zero_copy,
+                                     &delimiter, &length_prefix, &byteorder, &max_frame_size, &PyBool_Type, &batch)) {
+        return NULL;
+    }
+
+    if (!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    mode = PYUV_FRAMING_NONE;
+    if (delimiter != Py_None) {
+        if (!PyBytes_Check(delimiter) || PyBytes_GET_SIZE(delimiter) == 0) {
+            PyErr_SetString(PyExc_TypeError, "delimiter must be a non-empty bytes object");
+            return NULL;
+        }
+        mode = PYUV_FRAMING_DELIMITER;
+    }
+    if (length_prefix != 0) {
+        if (mode != PYUV_FRAMING_NONE) {
+            PyErr_SetString(PyExc_ValueError, "delimiter and length_prefix are mutually exclusive");
+            return NULL;
+        }
+        if (length_prefix != 1 && length_prefix != 2 && length_prefix != 4 && length_prefix != 8) {
+            PyErr_SetString(PyExc_ValueError, "length_prefix must be 1, 2, 4 or 8");
+            return NULL;
+        }
+        mode = PYUV_FRAMING_LENGTH;
+    }
+    if (strcmp(byteorder, "big") == 0) {
+        little_endian = False;
+    } else if (strcmp(byteorder, "little") == 0) {
+        little_endian = True;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "byteorder must be either 'little' or 'big'");
+        return NULL;
+    }
+    if (max_frame_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_frame_size must be a positive integer or zero");
+        return NULL;
+    }
+    if (mode == PYUV_FRAMING_NONE && (batch == Py_True || max_frame_size != 0)) {
+        PyErr_SetString(PyExc_ValueError, "batch and max_frame_size require a framing mode");
+        return NULL;
+    }
+    if (mode != PYUV_FRAMING_NONE && zero_copy == Py_True) {
+        PyErr_SetString(PyExc_ValueError, "zero_copy can't be used with a framing mode");
+        return NULL;
+    }
+
+    err = uv_read_start((uv_stream_t *)UV_HANDLE(self), (uv_alloc_cb)pyuv__alloc_cb, (uv_read_cb)pyuv__stream_read_cb);
+    if (err < 0) {
+        RAISE_STREAM_EXCEPTION(err, UV_HANDLE(self));
+        return NULL;
+    }
+
+    tmp = self->on_read_cb;
+    Py_INCREF(callback);
+    self->on_read_cb = callback;
+    Py_XDECREF(tmp);
+
+    self->read_zero_copy = (zero_copy == Py_True) ? True : False;
+    Py_CLEAR(self->read_into);
+    pyuv__stream_proxy_clear(self);
+
+    /* A partial frame is kept across stop_read / start_read unless the framing changes */
+    if (mode != self->framing.mode ||
+        (mode == PYUV_FRAMING_DELIMITER && PyObject_RichCompareBool(delimiter, self->framing.delimiter, Py_EQ) != 1) ||
+        (mode == PYUV_FRAMING_LENGTH && (length_prefix != self->framing.prefix_size || little_endian != self->framing.little_endian))) {
+        pyuv__stream_framing_reset(self);
+    }
+    tmp = self->framing.delimiter;
+    if (mode == PYUV_FRAMING_DELIMITER) {
+        Py_INCREF(delimiter);
+        self->framing.delimiter = delimiter;
+    } else {
+        self->framing.delimiter = NULL;
+    }
+    Py_XDECREF(tmp);
+    self->framing.mode = mode;
+    self->framing.prefix_size = length_prefix;
+    self->framing.little_endian = little_endian;
+    self->framing.max_size = (size_t)max_frame_size;
+    self->framing.batch = (batch == Py_True) ? True : False;
+
+    PYUV_HANDLE_INCREF(self);
 
     Py_RETURN_NONE;
-
-error:
-    Py_DECREF(callback);
-    PyMem_Free(ctx);
-    return NULL;
 }
 
 
 static PyObject *
-Stream_func_start_read(Stream *self, PyObject *args)
+Stream_func_start_read_into(Stream *self, PyObject *args)
 {
     int err;
-    PyObject *tmp, *callback;
+    Py_buffer view;
+    PyObject *tmp, *provider, *callback;
 
     tmp = NULL;
 
     RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
     RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
 
-    if (!PyArg_ParseTuple(args, "O:start_read", &callback)) {
+    if (!PyArg_ParseTuple(args, "OO:start_read_into", &provider, &callback)) {
         return NULL;
     }
 
+    if (!PyCallable_Check(provider)) {
+        /* Read-only buffers would otherwise only fail on the first read */
+        if (PyObject_GetBuffer(provider, &view, PyBUF_WRITABLE) != 0) {
+            PyErr_Clear();
+            PyErr_SetString(PyExc_TypeError, "buffer must be a writable buffer or a callable returning one");
+            return NULL;
+        }
+        PyBuffer_Release(&view);
+    }
+
     if (!PyCallable_Check(callback)) {
         PyErr_SetString(PyExc_TypeError, "a callable is required");
         return NULL;
     }
 
-    err = uv_read_start((uv_stream_t *)UV_HANDLE(self), (uv_alloc_cb)pyuv__alloc_cb, (uv_read_cb)pyuv__stream_read_cb);
+    err = uv_read_start((uv_stream_t *)UV_HANDLE(self), (uv_alloc_cb)pyuv__stream_alloc_into_cb, (uv_read_cb)pyuv__stream_read_into_cb);
     if (err < 0) {
         RAISE_STREAM_EXCEPTION(err, UV_HANDLE(self));
         return NULL;
@@ -223,6 +1015,15 @@ Stream_func_start_read(Stream *self, PyObject *args)
     self->on_read_cb = callback;
     Py_XDECREF(tmp);
 
+    tmp = self->read_into;
+    Py_INCREF(provider);
+    self->read_into = provider;
+    Py_XDECREF(tmp);
+
+    self->framing.mode = PYUV_FRAMING_NONE;
+    pyuv__stream_framing_reset(self);
+    pyuv__stream_proxy_clear(self);
+
     PYUV_HANDLE_INCREF(self);
 
     Py_RETURN_NONE;
@@ -245,6 +1046,8 @@ Stream_func_stop_read(Stream *self)
 
     Py_XDECREF(self->on_read_cb);
     self->on_read_cb = NULL;
+    Py_CLEAR(self->read_into);
+    pyuv__stream_proxy_clear(self);
 
     PYUV_HANDLE_DECREF(self);
 
@@ -252,6 +1055,75 @@ Stream_func_stop_read(Stream *self)
 }
 
 
+static PyObject *
+Stream_func_pipe_to(Stream *self, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    Py_ssize_t high;
+    PyObject *dest, *callback, *tmp;
+
+    static char *kwlist[] = {"dest", "callback", "high_watermark", NULL};
+
+    callback = Py_None;
+    high = PYUV_PROXY_HIGH_WATERMARK;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|On:pipe_to", kwlist, &StreamType, &dest, &callback, &high)) {
+        return NULL;
+    }
+
+    if (dest == (PyObject *)self) {
+        PyErr_SetString(PyExc_ValueError, "cannot pipe a stream to itself");
+        return NULL;
+    }
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(dest, NULL);
+    RAISE_IF_HANDLE_CLOSED(dest, PyExc_HandleClosedError, NULL);
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "'callback' must be a callable or None");
+        return NULL;
+    }
+
+    if (high < 0) {
+        PyErr_SetString(PyExc_ValueError, "high_watermark must be a positive integer or zero");
+        return NULL;
+    }
+
+    err = uv_read_start((uv_stream_t *)UV_HANDLE(self), (uv_alloc_cb)pyuv__alloc_cb, (uv_read_cb)pyuv__stream_proxy_read_cb);
+    if (err < 0) {
+        RAISE_STREAM_EXCEPTION(err, UV_HANDLE(self));
+        return NULL;
+    }
+
+    Py_CLEAR(self->on_read_cb);
+    Py_CLEAR(self->read_into);
+
+    tmp = self->proxy.dest;
+    Py_INCREF(dest);
+    self->proxy.dest = dest;
+    Py_XDECREF(tmp);
+
+    tmp = self->proxy.callback;
+    Py_INCREF(callback);
+    self->proxy.callback = callback;
+    Py_XDECREF(tmp);
+
+    self->proxy.high = (size_t)high;
+    self->proxy.bytes_read = 0;
+    self->proxy.bytes_written = 0;
+    self->proxy.active = True;
+    self->proxy.paused = False;
+    self->proxy.eof = False;
+
+    PYUV_HANDLE_INCREF(self);
+
+    Py_RETURN_NONE;
+}
+
+
 static PyObject *
 Stream_func_try_write(Stream *self, PyObject *args)
 {
@@ -266,6 +1138,13 @@ Stream_func_try_write(Stream *self, PyObject *args)
         return NULL;
     }
 
+    /* Buffered writes count as queued, data must not be written ahead of them */
+    if (self->buffered.head != NULL) {
+        RAISE_STREAM_EXCEPTION(UV_EAGAIN, UV_HANDLE(self));
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
     buf = uv_buf_init(view.buf, view.len);
     err = uv_try_write((uv_stream_t *)UV_HANDLE(self), &buf, 1);
     if (err < 0) {
@@ -279,6 +1158,227 @@ Stream_func_try_write(Stream *self, PyObject *args)
 }
 
 
+/* Try to write the buffers synchronously. Buffers which were fully written are skipped and a
+ * partially written one is adjusted, returns the index of the first buffer left to write. */
+static int
+pyuv__stream_eager_write(Stream *self, uv_buf_t *bufs, int nbufs)
+{
+    int i, r;
+
+    r = uv_try_write((uv_stream_t *)UV_HANDLE(self), bufs, nbufs);
+    if (r < 0) {
+        /* Not writable right now or an error, let the regular write path deal with it */
+        return 0;
+    }
+
+    for (i = 0; i < nbufs && (size_t)r >= bufs[i].len; i++) {
+        r -= bufs[i].len;
+    }
+    if (i < nbufs) {
+        bufs[i].base += r;
+        bufs[i].len -= r;
+    }
+
+    return i;
+}
+
+
+/* All data was written synchronously. Buffers are released right away and the callbacks
+ * (if any) are called on the next loop iteration. Each context holds a reference to self. */
+static void
+pyuv__stream_write_done(Stream *self, stream_write_ctx *ctx)
+{
+    int i;
+    Bool has_callback;
+    Loop *loop;
+    stream_write_ctx *c, *next;
+
+    loop = HANDLE(self)->loop;
+    has_callback = False;
+
+    for (c = ctx; c != NULL; c = c->next) {
+        for (i = 0; i < c->view_count; i++)
+            PyBuffer_Release(&c->views[i]);
+        if (c->views != c->viewsml)
+            PyMem_Free(c->views);
+        c->views = c->viewsml;
+        c->view_count = 0;
+        if (c->callback != Py_None)
+            has_callback = True;
+    }
+
+    if (!has_callback) {
+        for (c = ctx; c != NULL; c = next) {
+            next = c->next;
+            pyuv__stream_write_complete(loop, c, 0);
+        }
+        return;
+    }
+
+    ctx->req.handle = (uv_stream_t *)UV_HANDLE(self);
+    ctx->req.cb = pyuv__stream_write_cb;
+    pyuv__loop_defer_write(loop, &ctx->req);
+}
+
+
+/* Submit all buffered writes as a single write request, the contexts stay chained to
+ * the first one */
+static void
+pyuv__stream_flush_writes(Stream *self)
+{
+    int err, i, j, nbufs, pending;
+    uv_buf_t bufsml[16], *bufs;
+    stream_write_ctx *head, *ctx, *next;
+    Loop *loop;
+
+    head = self->buffered.head;
+    if (head == NULL) {
+        return;
+    }
+
+    loop = HANDLE(self)->loop;
+    nbufs = (int)self->buffered.nbufs;
+    self->buffered.head = self->buffered.tail = NULL;
+    self->buffered.nbufs = 0;
+    self->buffered.size = 0;
+
+    bufs = bufsml;
+    if ((size_t)nbufs > ARRAY_SIZE(bufsml)) {
+        bufs = PyMem_Malloc(sizeof(uv_buf_t) * nbufs);
+        if (!bufs) {
+            err = UV_ENOMEM;
+            goto error;
+        }
+    }
+
+    i = 0;
+    for (ctx = head; ctx != NULL; ctx = ctx->next) {
+        for (j = 0; j < ctx->view_count; j++) {
+            bufs[i++] = uv_buf_init(ctx->views[j].buf, ctx->views[j].len);
+        }
+    }
+
+    pending = 0;
+    if (self->eager_write) {
+        pending = pyuv__stream_eager_write(self, bufs, nbufs);
+        if (pending == nbufs) {
+            if (bufs != bufsml)
+                PyMem_Free(bufs);
+            pyuv__stream_write_done(self, head);
+            return;
+        }
+    }
+
+    err = uv_write(&head->req, (uv_stream_t *)UV_HANDLE(self), bufs + pending, nbufs - pending, pyuv__stream_write_cb);
+    if (bufs != bufsml)
+        PyMem_Free(bufs);
+    if (err == 0) {
+        return;
+    }
+
+error:
+    /* The writes were accepted already, report the error through their callbacks */
+    for (ctx = head; ctx != NULL; ctx = next) {
+        next = ctx->next;
+        pyuv__stream_write_complete(loop, ctx, err);
+    }
+}
+
+
+/* Flush the buffered writes of all streams which coalesce writes, right before polling */
+static void
+pyuv__stream_coalesce_cb(uv_prepare_t *handle)
+{
+    Loop *loop = handle->loop->data;
+    Bool released = loop->gil.tstate != NULL;
+    int gstate = pyuv__gil_ensure(handle->loop);
+    PyObject *streams;
+    Stream *stream;
+    Py_ssize_t i;
+
+    streams = loop->coalesce.streams;
+
+    /* Streams scheduled by the callbacks of failed writes are flushed in this same pass */
+    for (i = 0; i < PyList_GET_SIZE(streams); i++) {
+        stream = (Stream *)PyList_GET_ITEM(streams, i);
+        stream->buffered.scheduled = False;
+        if (!stream->corked) {
+            pyuv__stream_flush_writes(stream);
+        }
+    }
+
+    PyList_SetSlice(streams, 0, PyList_GET_SIZE(streams), NULL);
+    uv_prepare_stop(handle);
+
+    pyuv__gil_release(gstate);
+
+    /* The loop had already released the GIL ahead of polling, release it again */
+    if (released && loop->gil.tstate == NULL) {
+        loop->gil.tstate = PyEval_SaveThread();
+    }
+}
+
+
+static int
+pyuv__stream_schedule_flush(Stream *self)
+{
+    Loop *loop;
+
+    loop = HANDLE(self)->loop;
+
+    if (!loop->coalesce.initialized) {
+        loop->coalesce.streams = PyList_New(0);
+        if (!loop->coalesce.streams) {
+            return -1;
+        }
+        uv_prepare_init(loop->uv_loop, &loop->coalesce.prepare_h);
+        loop->coalesce.prepare_h.data = NULL;
+        loop->coalesce.initialized = True;
+    }
+
+    if (PyList_Append(loop->coalesce.streams, (PyObject *)self) < 0) {
+        return -1;
+    }
+
+    self->buffered.scheduled = True;
+    uv_prepare_start(&loop->coalesce.prepare_h, pyuv__stream_coalesce_cb);
+    return 0;
+}
+
+
+/* Buffer a write while the stream is corked or coalescing writes. The context holds a
+ * reference to self, just like a submitted write. */
+static void
+pyuv__stream_buffer_write(Stream *self, stream_write_ctx *ctx)
+{
+    int i;
+
+    ctx->next = NULL;
+    if (self->buffered.tail != NULL) {
+        self->buffered.tail->next = ctx;
+    } else {
+        self->buffered.head = ctx;
+    }
+    self->buffered.tail = ctx;
+    self->buffered.nbufs += ctx->view_count;
+    for (i = 0; i < ctx->view_count; i++) {
+        self->buffered.size += ctx->views[i].len;
+    }
+
+    Py_INCREF(self);
+
+    if (!self->corked && !self->buffered.scheduled) {
+        if (pyuv__stream_schedule_flush(self) < 0) {
+            /* Don't hold the data back if the flush couldn't be scheduled */
+            PyErr_Clear();
+            pyuv__stream_flush_writes(self);
+        }
+    }
+
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, pyuv__stream_write_queue_size(self));
+}
+
+
 static PyObject *
 pyuv__stream_write_bytes(Stream *self, PyObject *data, PyObject *callback, PyObject *send_handle)
 {
@@ -287,9 +1387,8 @@ pyuv__stream_write_bytes(Stream *self, PyObject *data, PyObject *callback, PyObj
     stream_write_ctx *ctx;
     Py_buffer *view;
 
-    ctx = PyMem_Malloc(sizeof *ctx);
+    ctx = pyuv__req_get(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.write, sizeof *ctx);
     if (!ctx) {
-        PyErr_NoMemory();
         return NULL;
     }
 
@@ -297,7 +1396,7 @@ pyuv__stream_write_bytes(Stream *self, PyObject *data, PyObject *callback, PyObj
     view = &ctx->views[0];
 
     if (PyObject_GetBuffer(data, view, PyBUF_SIMPLE) != 0) {
-        PyMem_Free(ctx);
+        pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.write, ctx);
         return NULL;
     }
 
@@ -305,11 +1404,26 @@ pyuv__stream_write_bytes(Stream *self, PyObject *data, PyObject *callback, PyObj
     ctx->obj = self;
     ctx->callback = callback;
     ctx->send_handle = send_handle;
+    ctx->next = NULL;
 
     Py_INCREF(callback);
     Py_XINCREF(send_handle);
 
+    if (send_handle == NULL && (self->corked || self->coalesce_writes)) {
+        pyuv__stream_buffer_write(self, ctx);
+        Py_RETURN_NONE;
+    }
+
+    /* Writes which were buffered before go first */
+    pyuv__stream_flush_writes(self);
+
     buf = uv_buf_init(view->buf, view->len);
+    if (send_handle == NULL && self->eager_write && pyuv__stream_eager_write(self, &buf, 1) == 1) {
+        Py_INCREF(self);
+        pyuv__stream_write_done(self, ctx);
+        Py_RETURN_NONE;
+    }
+
     if (send_handle != NULL) {
         ASSERT(UV_HANDLE(self)->type == UV_NAMED_PIPE);
         err = uv_write2(&ctx->req, (uv_stream_t *)UV_HANDLE(self), &buf, 1, (uv_stream_t *)UV_HANDLE(send_handle), pyuv__stream_write_cb);
@@ -322,13 +1436,15 @@ pyuv__stream_write_bytes(Stream *self, PyObject *data, PyObject *callback, PyObj
         Py_DECREF(callback);
         Py_XDECREF(send_handle);
         PyBuffer_Release(view);
-        PyMem_Free(ctx);
+        pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.write, ctx);
         return NULL;
     }
 
     /* Increase refcount so that object is not removed before the callback is called */
     Py_INCREF(self);
 
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, pyuv__stream_write_queue_size(self));
+
     Py_RETURN_NONE;
 }
 
@@ -336,7 +1452,7 @@ pyuv__stream_write_bytes(Stream *self, PyObject *data, PyObject *callback, PyObj
 static PyObject *
 pyuv__stream_write_sequence(Stream *self, PyObject *data, PyObject *callback, PyObject *send_handle)
 {
-    int err;
+    int err, pending;
     stream_write_ctx *ctx;
     PyObject *data_fast, *item;
     Py_ssize_t i, j, buf_count;
@@ -358,9 +1474,8 @@ pyuv__stream_write_sequence(Stream *self, PyObject *data, PyObject *callback, Py
         return NULL;
     }
 
-    ctx = PyMem_Malloc(sizeof *ctx);
+    ctx = pyuv__req_get(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.write, sizeof *ctx);
     if (!ctx) {
-        PyErr_NoMemory();
         Py_DECREF(data_fast);
         return NULL;
     }
@@ -370,7 +1485,7 @@ pyuv__stream_write_sequence(Stream *self, PyObject *data, PyObject *callback, Py
         ctx->views = PyMem_Malloc(sizeof(Py_buffer) * buf_count);
     if (!ctx->views) {
         PyErr_NoMemory();
-        PyMem_Free(ctx);
+        pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.write, ctx);
         Py_DECREF(data_fast);
         return NULL;
     }
@@ -390,15 +1505,36 @@ pyuv__stream_write_sequence(Stream *self, PyObject *data, PyObject *callback, Py
         ctx->obj = self;
         ctx->callback = callback;
         ctx->send_handle = send_handle;
+        ctx->next = NULL;
 
         Py_INCREF(callback);
         Py_XINCREF(send_handle);
 
+        if (send_handle == NULL && (self->corked || self->coalesce_writes)) {
+            pyuv__stream_buffer_write(self, ctx);
+            Py_DECREF(data_fast);
+            Py_RETURN_NONE;
+        }
+
+        /* Writes which were buffered before go first */
+        pyuv__stream_flush_writes(self);
+
+        pending = 0;
+        if (send_handle == NULL && self->eager_write) {
+            pending = pyuv__stream_eager_write(self, bufs, (int)buf_count);
+            if (pending == buf_count) {
+                Py_INCREF(self);
+                pyuv__stream_write_done(self, ctx);
+                Py_DECREF(data_fast);
+                Py_RETURN_NONE;
+            }
+        }
+
         if (send_handle != NULL) {
             ASSERT(UV_HANDLE(self)->type == UV_NAMED_PIPE);
             err = uv_write2(&ctx->req, (uv_stream_t *)UV_HANDLE(self), bufs, buf_count, (uv_stream_t *)UV_HANDLE(send_handle), pyuv__stream_write_cb);
         } else {
-            err = uv_write(&ctx->req, (uv_stream_t *)UV_HANDLE(self), bufs, buf_count, pyuv__stream_write_cb);
+            err = uv_write(&ctx->req, (uv_stream_t *)UV_HANDLE(self), bufs + pending, buf_count - pending, pyuv__stream_write_cb);
         }
     }
 
@@ -412,6 +1548,9 @@ pyuv__stream_write_sequence(Stream *self, PyObject *data, PyObject *callback, Py
     /* Increase refcount so that object is not removed before the callback is called */
     Py_INCREF(self);
 
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, pyuv__stream_write_queue_size(self));
+
+    Py_DECREF(data_fast);
     Py_RETURN_NONE;
 
 error:
@@ -419,7 +1558,7 @@ error:
         PyBuffer_Release(&ctx->views[j]);
     if (ctx->views != ctx->viewsml)
         PyMem_Free(ctx->views);
-    PyMem_Free(ctx);
+    pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.write, ctx);
     Py_XDECREF(data_fast);
     return NULL;
 }
@@ -454,6 +1593,56 @@ Stream_func_write(Stream *self, PyObject *args)
 }
 
 
+static PyObject *
+Stream_func_cork(Stream *self)
+{
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    self->corked = True;
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+Stream_func_uncork(Stream *self)
+{
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    self->corked = False;
+    pyuv__stream_flush_writes(self);
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+Stream_func_set_write_watermarks(Stream *self, PyObject *args)
+{
+    Py_ssize_t high, low;
+    PyObject *on_pause, *on_resume;
+
+    on_pause = on_resume = Py_None;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTuple(args, "nn|OO:set_write_watermarks", &high, &low, &on_pause, &on_resume)) {
+        return NULL;
+    }
+
+    if (pyuv__watermarks_set(&self->watermarks, high, low, on_pause, on_resume) < 0) {
+        return NULL;
+    }
+
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, pyuv__stream_write_queue_size(self));
+
+    Py_RETURN_NONE;
+}
+
+
 static PyObject *
 Stream_func_fileno(Stream *self)
 {
@@ -528,7 +1717,88 @@ Stream_write_queue_size_get(Stream *self, void *closure)
 
     RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
 
-    return PyLong_FromSize_t(((uv_stream_t *)UV_HANDLE(self))->write_queue_size);
+    return PyLong_FromSize_t(pyuv__stream_write_queue_size(self));
+}
+
+
+static PyObject *
+Stream_eager_write_get(Stream *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyBool_FromLong((long)self->eager_write);
+}
+
+
+static int
+Stream_eager_write_set(Stream *self, PyObject *value, void *closure)
+{
+    int eager;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    eager = PyObject_IsTrue(value);
+    if (eager == -1) {
+        return -1;
+    }
+
+    self->eager_write = eager ? True : False;
+    return 0;
+}
+
+
+static PyObject *
+Stream_coalesce_writes_get(Stream *self, void *closure)
+{
+    UNUSED_ARG(closure);
+    return PyBool_FromLong((long)self->coalesce_writes);
+}
+
+
+static int
+Stream_coalesce_writes_set(Stream *self, PyObject *value, void *closure)
+{
+    int coalesce;
+
+    UNUSED_ARG(closure);
+
+    if (!value) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+
+    coalesce = PyObject_IsTrue(value);
+    if (coalesce == -1) {
+        return -1;
+    }
+
+    self->coalesce_writes = coalesce ? True : False;
+    return 0;
+}
+
+
+static PyObject *
+Stream_pipe_stats_get(Stream *self, void *closure)
+{
+    PyObject *stats;
+
+    UNUSED_ARG(closure);
+
+    stats = PyStructSequence_New(&PipeStatsResultType);
+    if (!stats) {
+        return NULL;
+    }
+
+    PyStructSequence_SET_ITEM(stats, 0, PyLong_FromUnsignedLongLong(self->proxy.bytes_read));
+    PyStructSequence_SET_ITEM(stats, 1, PyLong_FromUnsignedLongLong(self->proxy.bytes_written));
+    PyStructSequence_SET_ITEM(stats, 2, PyInt_FromLong((long)self->proxy.pending));
+    PyStructSequence_SET_ITEM(stats, 3, PyBool_FromLong((long)self->proxy.paused));
+
+    return stats;
 }
 
 
@@ -547,6 +1817,11 @@ static int
 Stream_tp_traverse(Stream *self, visitproc visit, void *arg)
 {
     Py_VISIT(self->on_read_cb);
+    Py_VISIT(self->read_into);
+    Py_VISIT(self->watermarks.on_pause);
+    Py_VISIT(self->watermarks.on_resume);
+    Py_VISIT(self->proxy.dest);
+    Py_VISIT(self->proxy.callback);
     return HandleType.tp_traverse((PyObject *)self, visit, arg);
 }
 
@@ -555,6 +1830,19 @@ static int
 Stream_tp_clear(Stream *self)
 {
     Py_CLEAR(self->on_read_cb);
+    Py_CLEAR(self->read_buffer);
+    Py_CLEAR(self->read_into);
+    Py_CLEAR(self->watermarks.on_pause);
+    Py_CLEAR(self->watermarks.on_resume);
+    Py_CLEAR(self->framing.delimiter);
+    Py_CLEAR(self->proxy.dest);
+    Py_CLEAR(self->proxy.callback);
+    PyMem_Free(self->framing.buf);
+    self->framing.buf = NULL;
+    self->framing.len = self->framing.size = 0;
+    if (self->read_into_view.obj != NULL) {
+        PyBuffer_Release(&self->read_into_view);
+    }
     return HandleType.tp_clear((PyObject *)self);
 }
 
@@ -564,8 +1852,13 @@ Stream_tp_methods[] = {
     { "shutdown", (PyCFunction)Stream_func_shutdown, METH_VARARGS, "Shutdown the write side of this Stream." },
     { "try_write", (PyCFunction)Stream_func_try_write, METH_VARARGS, "Try to write data on the stream." },
     { "write", (PyCFunction)Stream_func_write, METH_VARARGS, "Write data on the stream." },
-    { "start_read", (PyCFunction)Stream_func_start_read, METH_VARARGS, "Start read data from the connected endpoint." },
+    { "start_read", (PyCFunction)Stream_func_start_read, METH_VARARGS|METH_KEYWORDS, "Start read data from the connected endpoint." },
+    { "start_read_into", (PyCFunction)Stream_func_start_read_into, METH_VARARGS, "Start reading data from the connected endpoint into the given buffer." },
     { "stop_read", (PyCFunction)Stream_func_stop_read, METH_NOARGS, "Stop read data from the connected endpoint." },
+    { "pipe_to", (PyCFunction)Stream_func_pipe_to, METH_VARARGS|METH_KEYWORDS, "Forward all data read from this stream to another stream." },
+    { "cork", (PyCFunction)Stream_func_cork, METH_NOARGS, "Buffer writes until uncork is called." },
+    { "uncork", (PyCFunction)Stream_func_uncork, METH_NOARGS, "Write all buffered data at once." },
+    { "set_write_watermarks", (PyCFunction)Stream_func_set_write_watermarks, METH_VARARGS, "Set the write queue watermarks used for flow control." },
     { "fileno", (PyCFunction)Stream_func_fileno, METH_NOARGS, "Returns the libuv OS handle." },
     { "set_blocking", (PyCFunction)Stream_func_set_blocking, METH_VARARGS, "Set the stream to be blocking." },
     { NULL }
@@ -576,6 +1869,9 @@ static PyGetSetDef Stream_tp_getsets[] = {
     {"readable", (getter)Stream_readable_get, 0, "Indicates if stream is readable.", NULL},
     {"writable", (getter)Stream_writable_get, 0, "Indicates if stream is writable.", NULL},
     {"write_queue_size", (getter)Stream_write_queue_size_get, 0, "Returns the size of the write queue.", NULL},
+    {"eager_write", (getter)Stream_eager_write_get, (setter)Stream_eager_write_set, "Try to write data synchronously before queueing a write request.", NULL},
+    {"pipe_stats", (getter)Stream_pipe_stats_get, NULL, "Statistics about data forwarded with pipe_to.", NULL},
+    {"coalesce_writes", (getter)Stream_coalesce_writes_get, (setter)Stream_coalesce_writes_set, "Buffer writes and write them all at once before the loop polls for i/o.", NULL},
     {NULL}
 };
 
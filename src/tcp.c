@@ -2,7 +2,7 @@
 static void
 pyuv__tcp_listen_cb(uv_stream_t *handle, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     TCP *self;
     PyObject *result, *py_errorno;
 
@@ -28,14 +28,14 @@ pyuv__tcp_listen_cb(uv_stream_t *handle, int status)
     Py_DECREF(py_errorno);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
 static void
 pyuv__tcp_connect_cb(uv_connect_t *req, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->handle->loop);
     TCP *self;
     PyObject *callback, *result, *py_errorno;
 
@@ -63,7 +63,7 @@ pyuv__tcp_connect_cb(uv_connect_t *req, int status)
     /* Refcount was increased in the caller function */
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
@@ -2,7 +2,7 @@
 static void
 pyuv__timer_cb(uv_timer_t *handle)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Timer *self;
     PyObject *result;
 
@@ -19,7 +19,7 @@ pyuv__timer_cb(uv_timer_t *handle)
     Py_XDECREF(result);
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
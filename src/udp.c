@@ -1,4 +1,19 @@
 
+#ifdef __linux__
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+/* The callbacks may stop receiving or close the handle while we are reading */
+#define PYUV_UDP_RECEIVING(self) ((self)->on_read_cb != NULL && !uv_is_closing(UV_HANDLE(self)))
+/* Limits for a single GSO send: segments per call and total UDP payload */
+#define PYUV_UDP_GSO_MAX_SEGMENTS 64
+#define PYUV_UDP_GSO_MAX_BYTES 65507
+#endif
+
 typedef struct {
     uv_udp_send_t req;
     PyObject *callback;
@@ -7,11 +22,89 @@ typedef struct {
     int view_count;
 } udp_send_ctx;
 
+/* Number of datagrams read by each recvmmsg call when receiving in batches */
+#define PYUV_UDP_MMSG_CHUNK 64
+
+/* Maximum number of datagrams passed to a single sendmmsg call (UIO_MAXIOV) */
+#define PYUV_UDP_SENDMMSG_MAX 1024
+
+typedef struct {
+    UDP *udp;
+    PyObject *callback;
+    PyObject *errors;
+    Py_ssize_t count;
+    Py_ssize_t pending;
+    struct sockaddr_storage *addrs;
+    uv_buf_t *bufs;
+    Py_buffer *views;
+    Py_ssize_t view_count;
+    struct udp_send_many_req_s *reqs;
+    uv_write_t deferred_req;
+    size_t segment_size;
+    Bool single;
+} udp_send_many_ctx;
+
+typedef struct udp_send_many_req_s {
+    uv_udp_send_t req;
+    udp_send_many_ctx *ctx;
+    Py_ssize_t index;
+} udp_send_many_req;
+
+static PyObject *pyuv__udp_send_segmented(UDP *self, struct sockaddr_storage *ss, PyObject *data, Py_ssize_t segment_size, PyObject *callback);
+
+
+/* Received addresses come from a small direct-mapped cache of Address objects, so datagrams
+ * from the same peers don't allocate a new address each time. Connected handles can only
+ * receive from their peer, so they always get the same object. */
+static PyObject *
+pyuv__udp_peer_address(UDP *self, const struct sockaddr *addr)
+{
+    unsigned int h;
+    PyObject *peer;
+    const struct sockaddr_in *addr4;
+    const struct sockaddr_in6 *addr6;
+
+    if (self->connected) {
+        Py_INCREF(self->peer_address);
+        return self->peer_address;
+    }
+
+    switch (addr->sa_family) {
+        case AF_INET:
+            addr4 = (const struct sockaddr_in *)addr;
+            h = (unsigned int)addr4->sin_addr.s_addr ^ addr4->sin_port;
+            break;
+        case AF_INET6:
+            addr6 = (const struct sockaddr_in6 *)addr;
+            memcpy(&h, &addr6->sin6_addr.s6_addr[12], sizeof(h));
+            h ^= addr6->sin6_port;
+            break;
+        default:
+            return makesockaddr((struct sockaddr *)addr);
+    }
+    h ^= h >> 16;
+    h ^= h >> 8;
+    h %= PYUV_UDP_PEER_CACHE_SIZE;
+
+    peer = self->peers[h];
+    if (peer == NULL || !pyuv__sockaddr_equal((struct sockaddr *)PYUV_ADDRESS_SOCKADDR(peer), addr)) {
+        peer = pyuv__address_new(addr);
+        if (peer == NULL) {
+            return NULL;
+        }
+        Py_XDECREF(self->peers[h]);
+        self->peers[h] = peer;
+    }
+
+    Py_INCREF(peer);
+    return peer;
+}
+
 
 static void
 pyuv__udp_recv_cd(uv_udp_t* handle, int nread, const uv_buf_t* buf, struct sockaddr* addr, unsigned flags)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(handle->loop);
     Loop *loop;
     UDP *self;
     PyObject *result, *address_tuple, *data, *py_errorno;
@@ -31,7 +124,7 @@ pyuv__udp_recv_cd(uv_udp_t* handle, int nread, const uv_buf_t* buf, struct socka
 
     if (nread >= 0) {
         ASSERT(addr);
-        address_tuple = makesockaddr(addr);
+        address_tuple = pyuv__udp_peer_address(self, addr);
         if (nread == 0) {
             data = PyBytes_FromString("");
         } else {
@@ -57,22 +150,354 @@ pyuv__udp_recv_cd(uv_udp_t* handle, int nread, const uv_buf_t* buf, struct socka
     Py_DECREF(py_errorno);
 
 done:
-    /* data has been read, unlock the buffer */
+    /* data has been read, return the buffer to the pool */
+    loop = handle->loop->data;
+    ASSERT(loop);
+    pyuv__buffer_put(loop, buf->base);
+
+    Py_DECREF(self);
+    pyuv__gil_release(gstate);
+}
+
+
+/*
+ * Batched receive. Datagrams are collected into a list of (address, data) tuples which is handed
+ * to the callback once the socket is drained (libuv reports EAGAIN with a NULL address) or the
+ * list is full. On Linux the rest of the queue is read with recvmmsg as soon as the first datagram
+ * arrives.
+ */
+static int
+pyuv__udp_batch_append(UDP *self, const struct sockaddr *addr, const char *data, Py_ssize_t len)
+{
+    int r;
+    PyObject *item, *address, *bytes;
+
+    if (self->batch.datagrams == NULL) {
+        self->batch.datagrams = PyList_New(0);
+        if (self->batch.datagrams == NULL) {
+            return -1;
+        }
+    }
+
+    address = pyuv__udp_peer_address(self, addr);
+    if (address == NULL) {
+        return -1;
+    }
+
+    bytes = PyBytes_FromStringAndSize(data, len);
+    if (bytes == NULL) {
+        Py_DECREF(address);
+        return -1;
+    }
+    item = PyTuple_Pack(2, address, bytes);
+    Py_DECREF(address);
+    Py_DECREF(bytes);
+    if (item == NULL) {
+        return -1;
+    }
+    r = PyList_Append(self->batch.datagrams, item);
+    Py_DECREF(item);
+    return r;
+}
+
+
+static void
+pyuv__udp_batch_flush(UDP *self, PyObject *py_errorno)
+{
+    PyObject *datagrams, *result;
+
+    datagrams = self->batch.datagrams;
+    self->batch.datagrams = NULL;
+
+    if (datagrams == NULL) {
+        if (py_errorno == Py_None) {
+            return;
+        }
+        Py_INCREF(Py_None);
+        datagrams = Py_None;
+    }
+
+    result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, datagrams, py_errorno, NULL);
+    if (result == NULL) {
+        handle_uncaught_exception(HANDLE(self)->loop);
+    }
+    Py_XDECREF(result);
+    Py_DECREF(datagrams);
+}
+
+
+#ifdef __linux__
+static void
+pyuv__udp_recvmmsg(UDP *self)
+{
+    int r;
+    unsigned int i, n;
+    size_t len;
+    uv_os_fd_t fd;
+    Loop *loop;
+    char *bufs[PYUV_UDP_MMSG_CHUNK];
+    struct iovec iov[PYUV_UDP_MMSG_CHUNK];
+    struct mmsghdr msgs[PYUV_UDP_MMSG_CHUNK];
+    struct sockaddr_storage addrs[PYUV_UDP_MMSG_CHUNK];
+
+    if (uv_fileno(UV_HANDLE(self), &fd) < 0) {
+        return;
+    }
+    loop = HANDLE(self)->loop;
+
+    while (PyList_GET_SIZE(self->batch.datagrams) < self->batch.max) {
+        n = 0;
+        while (n < PYUV_UDP_MMSG_CHUNK && n < self->batch.max - PyList_GET_SIZE(self->batch.datagrams)) {
+            bufs[n] = pyuv__buffer_get(loop, &len);
+            if (bufs[n] == NULL) {
+                break;
+            }
+            iov[n].iov_base = bufs[n];
+            iov[n].iov_len = len;
+            memset(&msgs[n], 0, sizeof(msgs[n]));
+            msgs[n].msg_hdr.msg_name = &addrs[n];
+            msgs[n].msg_hdr.msg_namelen = sizeof(addrs[n]);
+            msgs[n].msg_hdr.msg_iov = &iov[n];
+            msgs[n].msg_hdr.msg_iovlen = 1;
+            n++;
+        }
+        if (n == 0) {
+            return;
+        }
+
+        do {
+            r = recvmmsg(fd, msgs, n, 0, NULL);
+        } while (r < 0 && errno == EINTR);
+
+        /* errors other than EAGAIN get reported by libuv on its next read */
+        for (i = 0; i < (unsigned int)(r > 0 ? r : 0); i++) {
+            if (pyuv__udp_batch_append(self, (struct sockaddr *)&addrs[i], bufs[i], msgs[i].msg_len) != 0) {
+                handle_uncaught_exception(loop);
+            }
+        }
+        for (i = 0; i < n; i++) {
+            pyuv__buffer_put(loop, bufs[i]);
+        }
+
+        if (r < (int)n) {
+            return;
+        }
+    }
+}
+#endif
+
+
+#ifdef __linux__
+/* Deliver a datagram read by pyuv__udp_recv_gro_cb, in a batch or on its own */
+static void
+pyuv__udp_deliver(UDP *self, const struct sockaddr *addr, const char *data, Py_ssize_t len)
+{
+    PyObject *result, *address_tuple, *bytes, *py_flags;
+
+    if (self->batch.max > 0) {
+        if (pyuv__udp_batch_append(self, addr, data, len) != 0) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+        }
+        if (self->batch.datagrams != NULL && PyList_GET_SIZE(self->batch.datagrams) >= self->batch.max) {
+            pyuv__udp_batch_flush(self, Py_None);
+        }
+        return;
+    }
+
+    address_tuple = pyuv__udp_peer_address(self, addr);
+    bytes = PyBytes_FromStringAndSize(data, len);
+    py_flags = PyInt_FromLong(0);
+    if (address_tuple == NULL || bytes == NULL || py_flags == NULL) {
+        handle_uncaught_exception(HANDLE(self)->loop);
+    } else {
+        result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, address_tuple, py_flags, bytes, Py_None, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(HANDLE(self)->loop);
+        }
+        Py_XDECREF(result);
+    }
+    Py_XDECREF(address_tuple);
+    Py_XDECREF(bytes);
+    Py_XDECREF(py_flags);
+}
+
+
+/* An empty buffer makes libuv report UV_ENOBUFS without reading, so we can read the socket
+ * ourselves and get the GRO segment size out of the control data */
+static void
+pyuv__udp_gro_alloc_cb(uv_handle_t* handle, size_t suggested_size, uv_buf_t *buf)
+{
+    UNUSED_ARG(handle);
+    UNUSED_ARG(suggested_size);
+
+    buf->base = NULL;
+    buf->len = 0;
+}
+
+
+static void
+pyuv__udp_recv_gro_cb(uv_udp_t* handle, int nread, const uv_buf_t* buf, struct sockaddr* addr, unsigned flags)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    int count, gso_size;
+    ssize_t r, off, segment;
+    size_t len;
+    char *data;
+    char control[CMSG_SPACE(sizeof(int))];
+    uv_os_fd_t fd;
+    Loop *loop;
+    UDP *self;
+    PyObject *result, *py_errorno;
+    struct sockaddr_storage peer;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+
+    ASSERT(handle);
+    ASSERT(nread == UV_ENOBUFS);
+
+    UNUSED_ARG(buf);
+    UNUSED_ARG(addr);
+    UNUSED_ARG(flags);
+
+    self = PYUV_CONTAINER_OF(handle, UDP, udp_h);
+    loop = handle->loop->data;
+    ASSERT(loop);
+
+    /* Object could go out of scope in the callback, increase refcount to avoid it */
+    Py_INCREF(self);
+
+    data = pyuv__buffer_get(loop, &len);
+    if (data == NULL || uv_fileno(UV_HANDLE(self), &fd) < 0) {
+        goto done;
+    }
+
+    /* Same limit libuv uses, so other handles don't starve */
+    for (count = 0; count < 32 && PYUV_UDP_RECEIVING(self); count++) {
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base = data;
+        iov.iov_len = len;
+        msg.msg_name = &peer;
+        msg.msg_namelen = sizeof(peer);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        do {
+            r = recvmsg(fd, &msg, 0);
+        } while (r < 0 && errno == EINTR);
+
+        if (r < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                py_errorno = PyInt_FromLong((long)-errno);
+                if (self->batch.max > 0) {
+                    pyuv__udp_batch_flush(self, Py_None);
+                    if (PYUV_UDP_RECEIVING(self)) {
+                        pyuv__udp_batch_flush(self, py_errorno);
+                    }
+                } else {
+                    result = PyObject_CallFunctionObjArgs(self->on_read_cb, self, Py_None, Py_None, Py_None, py_errorno, NULL);
+                    if (result == NULL) {
+                        handle_uncaught_exception(loop);
+                    }
+                    Py_XDECREF(result);
+                }
+                Py_XDECREF(py_errorno);
+            }
+            break;
+        }
+
+        /* Without GRO control data the buffer holds a single datagram */
+        segment = r;
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+                memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                if (gso_size > 0) {
+                    segment = gso_size;
+                }
+            }
+        }
+
+        if (r == 0) {
+            pyuv__udp_deliver(self, (struct sockaddr *)&peer, data, 0);
+        }
+        for (off = 0; off < r && PYUV_UDP_RECEIVING(self); off += segment) {
+            pyuv__udp_deliver(self, (struct sockaddr *)&peer, data + off, (r - off) < segment ? (r - off) : segment);
+        }
+    }
+
+    if (self->batch.max > 0 && PYUV_UDP_RECEIVING(self)) {
+        pyuv__udp_batch_flush(self, Py_None);
+    }
+
+done:
+    pyuv__buffer_put(loop, data);
+    Py_DECREF(self);
+    pyuv__gil_release(gstate);
+}
+#endif
+
+
+static void
+pyuv__udp_recv_batch_cb(uv_udp_t* handle, int nread, const uv_buf_t* buf, struct sockaddr* addr, unsigned flags)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    Loop *loop;
+    UDP *self;
+    PyObject *py_errorno;
+
+    ASSERT(handle);
+
+    UNUSED_ARG(flags);
+
+    self = PYUV_CONTAINER_OF(handle, UDP, udp_h);
     loop = handle->loop->data;
     ASSERT(loop);
-    loop->buffer.in_use = False;
+
+    /* Object could go out of scope in the callback, increase refcount to avoid it */
+    Py_INCREF(self);
+
+    if (nread == 0 && addr == NULL) {
+        /* libuv got EAGAIN, the socket is drained */
+        pyuv__buffer_put(loop, buf->base);
+        pyuv__udp_batch_flush(self, Py_None);
+    } else if (nread < 0) {
+        pyuv__buffer_put(loop, buf->base);
+        pyuv__udp_batch_flush(self, Py_None);
+        if (self->on_read_cb != NULL) {
+            py_errorno = PyInt_FromLong((long)nread);
+            pyuv__udp_batch_flush(self, py_errorno);
+            Py_XDECREF(py_errorno);
+        }
+    } else {
+        ASSERT(addr);
+        if (pyuv__udp_batch_append(self, addr, buf->base, nread) != 0) {
+            handle_uncaught_exception(loop);
+        }
+        pyuv__buffer_put(loop, buf->base);
+#ifdef __linux__
+        if (self->batch.datagrams != NULL) {
+            pyuv__udp_recvmmsg(self);
+        }
+#endif
+        if (self->batch.datagrams != NULL && PyList_GET_SIZE(self->batch.datagrams) >= self->batch.max) {
+            pyuv__udp_batch_flush(self, Py_None);
+        }
+    }
 
     Py_DECREF(self);
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
 }
 
 
 static void
 pyuv__udp_send_cb(uv_udp_send_t* req, int status)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int gstate = pyuv__gil_ensure(req->handle->loop);
     int i;
     udp_send_ctx *ctx;
+    Loop *loop;
     UDP *self;
     PyObject *callback, *result, *py_errorno;
 
@@ -105,280 +530,1010 @@ pyuv__udp_send_cb(uv_udp_send_t* req, int status)
         PyBuffer_Release(&ctx->views[i]);
     if (ctx->views != ctx->viewsml)
         PyMem_Free(ctx->views);
-    PyMem_Free(ctx);
+    loop = req->handle->loop->data;
+    pyuv__req_put(loop, &loop->reqs.udp_send, ctx);
+
+    if (!uv_is_closing(UV_HANDLE(self))) {
+        pyuv__watermarks_update(&self->watermarks, (PyObject *)self, loop, self->udp_h.send_queue_size);
+    }
 
     /* Refcount was increased in the caller function */
     Py_DECREF(self);
 
-    PyGILState_Release(gstate);
+    pyuv__gil_release(gstate);
+}
+
+
+static PyObject *
+UDP_func_bind(UDP *self, PyObject *args)
+{
+    int err, flags;
+    struct sockaddr_storage ss;
+    PyObject *addr;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    flags = 0;
+
+    if (!PyArg_ParseTuple(args, "O|i:bind", &addr, &flags)) {
+        return NULL;
+    }
+
+    if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
+        /* Error is set by the function itself */
+        return NULL;
+    }
+
+    err = uv_udp_bind(&self->udp_h, (struct sockaddr *)&ss, flags);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
+#ifdef __linux__
+/* libuv creates the socket lazily, bind it to the wildcard address like it would do */
+static int
+pyuv__udp_ensure_bound(UDP *self, int family, uv_os_fd_t *fd)
+{
+    int err;
+    struct sockaddr_storage any;
+
+    if (uv_fileno(UV_HANDLE(self), fd) == 0) {
+        return 0;
+    }
+
+    memset(&any, 0, sizeof(any));
+    any.ss_family = family;
+    if (family == AF_INET6) {
+        ((struct sockaddr_in6 *)&any)->sin6_addr = in6addr_any;
+    } else {
+        ((struct sockaddr_in *)&any)->sin_addr.s_addr = INADDR_ANY;
+    }
+    err = uv_udp_bind(&self->udp_h, (struct sockaddr *)&any, 0);
+    if (err < 0) {
+        return err;
+    }
+
+    return uv_fileno(UV_HANDLE(self), fd);
+}
+
+
+static int
+pyuv__udp_set_gro(UDP *self, Bool on)
+{
+    int err, value;
+    uv_os_fd_t fd;
+
+    err = pyuv__udp_ensure_bound(self, AF_INET, &fd);
+    if (err < 0) {
+        return err;
+    }
+
+    value = on ? 1 : 0;
+    if (setsockopt(fd, IPPROTO_UDP, UDP_GRO, &value, sizeof(value)) != 0) {
+        return -errno;
+    }
+
+    self->gro = on;
+    return 0;
+}
+#endif
+
+
+static PyObject *
+UDP_func_start_recv(UDP *self, PyObject *args, PyObject *kwargs)
+{
+    int err;
+    Py_ssize_t max_batch;
+    PyObject *tmp, *callback, *gro;
+#ifdef __linux__
+    Bool gro_was_on;
+#endif
+
+    static char *kwlist[] = {"callback", "max_batch", "gro", NULL};
+
+    tmp = NULL;
+    max_batch = 0;
+    gro = Py_False;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nO:start_recv", kwlist, &callback, &max_batch, &gro)) {
+        return NULL;
+    }
+
+    if (!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "a callable is required");
+        return NULL;
+    }
+
+    if (max_batch < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_batch must be a non-negative integer");
+        return NULL;
+    }
+
+    if (PyObject_IsTrue(gro)) {
+#ifdef __linux__
+        gro_was_on = self->gro;
+        if (uv_is_active(UV_HANDLE(self))) {
+            /* Don't touch the socket under an ongoing receive */
+            err = UV_EALREADY;
+        } else {
+            err = pyuv__udp_set_gro(self, True);
+            if (err == 0) {
+                err = uv_udp_recv_start(&self->udp_h, (uv_alloc_cb)pyuv__udp_gro_alloc_cb, (uv_udp_recv_cb)pyuv__udp_recv_gro_cb);
+                if (err < 0 && !gro_was_on) {
+                    pyuv__udp_set_gro(self, False);
+                }
+            }
+        }
+#else
+        err = UV_ENOTSUP;
+#endif
+    } else if (max_batch > 0) {
+        err = uv_udp_recv_start(&self->udp_h, (uv_alloc_cb)pyuv__alloc_cb, (uv_udp_recv_cb)pyuv__udp_recv_batch_cb);
+    } else {
+        err = uv_udp_recv_start(&self->udp_h, (uv_alloc_cb)pyuv__alloc_cb, (uv_udp_recv_cb)pyuv__udp_recv_cd);
+    }
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        return NULL;
+    }
+
+    self->batch.max = max_batch;
+
+    tmp = self->on_read_cb;
+    Py_INCREF(callback);
+    self->on_read_cb = callback;
+    Py_XDECREF(tmp);
+
+    PYUV_HANDLE_INCREF(self);
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+UDP_func_stop_recv(UDP *self)
+{
+    int err;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    err = uv_udp_recv_stop(&self->udp_h);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        return NULL;
+    }
+
+    Py_XDECREF(self->on_read_cb);
+    self->on_read_cb = NULL;
+    Py_CLEAR(self->batch.datagrams);
+
+#ifdef __linux__
+    if (self->gro) {
+        /* libuv can't deal with coalesced datagrams */
+        pyuv__udp_set_gro(self, False);
+    }
+#endif
+
+    PYUV_HANDLE_DECREF(self);
+
+    Py_RETURN_NONE;
+}
+
+
+#ifdef __linux__
+/* Like uv_udp_try_send, without a destination */
+static int
+pyuv__udp_try_send_connected(UDP *self, uv_buf_t *buf)
+{
+    int r;
+    uv_os_fd_t fd;
+
+    if (self->udp_h.send_queue_count > 0) {
+        return UV_EAGAIN;
+    }
+
+    r = uv_fileno(UV_HANDLE(self), &fd);
+    if (r < 0) {
+        return r;
+    }
+
+    do {
+        r = send(fd, buf->base, buf->len, 0);
+    } while (r < 0 && errno == EINTR);
+
+    if (r < 0) {
+        return errno == EWOULDBLOCK ? UV_EAGAIN : -errno;
+    }
+    return r;
+}
+#endif
+
+
+/* Linux only: queued sends go through uv_udp_send with the peer address as destination,
+ * which BSD derived systems reject on connected sockets */
+static PyObject *
+UDP_func_connect(UDP *self, PyObject *args)
+{
+#ifdef __linux__
+    int err;
+    uv_os_fd_t fd;
+    struct sockaddr_storage ss;
+    PyObject *addr, *peer_address;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTuple(args, "O:connect", &addr)) {
+        return NULL;
+    }
+
+    if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
+        /* Error is set by the function itself */
+        return NULL;
+    }
+
+    err = pyuv__udp_ensure_bound(self, ss.ss_family, &fd);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        return NULL;
+    }
+
+    peer_address = pyuv__address_new((struct sockaddr *)&ss);
+    if (peer_address == NULL) {
+        return NULL;
+    }
+
+    do {
+        err = connect(fd, (struct sockaddr *)&ss, pyuv__sockaddr_len((struct sockaddr *)&ss));
+    } while (err < 0 && errno == EINTR);
+
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(-errno, PyExc_UDPError);
+        Py_DECREF(peer_address);
+        return NULL;
+    }
+
+    Py_XDECREF(self->peer_address);
+    self->peer_address = peer_address;
+    memcpy(&self->peer, &ss, sizeof(ss));
+    self->connected = True;
+
+    Py_RETURN_NONE;
+#else
+    UNUSED_ARG(args);
+    RAISE_UV_EXCEPTION(UV_ENOTSUP, PyExc_UDPError);
+    return NULL;
+#endif
+}
+
+
+static PyObject *
+UDP_func_getpeername(UDP *self)
+{
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!self->connected) {
+        RAISE_UV_EXCEPTION(UV_ENOTCONN, PyExc_UDPError);
+        return NULL;
+    }
+
+    return makesockaddr((struct sockaddr *)&self->peer);
+}
+
+
+static PyObject *
+UDP_func_try_send(UDP *self, PyObject *args)
+{
+    int err;
+    uv_buf_t buf;
+    Py_buffer view;
+    PyObject *addr;
+    struct sockaddr_storage ss;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTuple(args, "O"PYUV_BYTES"*:try_send", &addr, &view)) {
+        return NULL;
+    }
+
+    if (addr == Py_None) {
+        if (!self->connected) {
+            RAISE_UV_EXCEPTION(UV_ENOTCONN, PyExc_UDPError);
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+    } else if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
+        /* Error is set by the function itself */
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    buf = uv_buf_init(view.buf, view.len);
+#ifdef __linux__
+    if (addr == Py_None) {
+        err = pyuv__udp_try_send_connected(self, &buf);
+    } else
+#endif
+    err = uv_udp_try_send(&self->udp_h, &buf, 1, (struct sockaddr*) &ss);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    PyBuffer_Release(&view);
+    return PyInt_FromLong((long)err);
+}
+
+
+static PyObject *
+pyuv__udp_send_bytes(UDP *self, struct sockaddr *addr, PyObject *data, PyObject *callback)
+{
+    int err;
+    uv_buf_t buf;
+    udp_send_ctx *ctx;
+    Py_buffer *view;
+
+    ctx = pyuv__req_get(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.udp_send, sizeof *ctx);
+    if (!ctx) {
+        return NULL;
+    }
+
+    ctx->views = ctx->viewsml;
+    view = &ctx->views[0];
+
+    if (PyObject_GetBuffer(data, view, PyBUF_SIMPLE) != 0) {
+        pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.udp_send, ctx);
+        return NULL;
+    }
+
+    ctx->view_count = 1;
+    ctx->callback = callback;
+
+    Py_INCREF(callback);
+
+    buf = uv_buf_init(view->buf, view->len);
+
+    err = uv_udp_send(&ctx->req, &self->udp_h, &buf, 1, addr, (uv_udp_send_cb)pyuv__udp_send_cb);
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        Py_DECREF(callback);
+        PyBuffer_Release(view);
+        pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.udp_send, ctx);
+        return NULL;
+    }
+
+    /* Increase refcount so that object is not removed before the callback is called */
+    Py_INCREF(self);
+
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, self->udp_h.send_queue_size);
+
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+pyuv__udp_send_sequence(UDP *self, struct sockaddr *addr, PyObject *data, PyObject *callback)
+{
+    int err;
+    udp_send_ctx *ctx;
+    PyObject *data_fast, *item;
+    Py_ssize_t i, j, buf_count;
+
+    data_fast = PySequence_Fast(data, "data must be an iterable");
+    if (data_fast == NULL)
+        return NULL;
+
+    buf_count = PySequence_Fast_GET_SIZE(data_fast);
+    if (buf_count > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "iterable is too long");
+        Py_DECREF(data_fast);
+        return NULL;
+    }
+
+    if (buf_count == 0) {
+        PyErr_SetString(PyExc_ValueError, "iterable is empty");
+        Py_DECREF(data_fast);
+        return NULL;
+    }
+
+    ctx = pyuv__req_get(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.udp_send, sizeof *ctx);
+    if (!ctx) {
+        Py_DECREF(data_fast);
+        return NULL;
+    }
+
+    ctx->views = ctx->viewsml;
+    if (buf_count > ARRAY_SIZE(ctx->viewsml))
+        ctx->views = PyMem_Malloc(sizeof(Py_buffer) * buf_count);
+    if (!ctx->views) {
+        PyErr_NoMemory();
+        pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.udp_send, ctx);
+        Py_DECREF(data_fast);
+        return NULL;
+    }
+    ctx->view_count = buf_count;
+
+    {
+        STACK_ARRAY(uv_buf_t, bufs, buf_count);
+
+        for (i = 0; i < buf_count; i++) {
+            item = PySequence_Fast_GET_ITEM(data_fast, i);
+            if (PyObject_GetBuffer(item, &ctx->views[i], PyBUF_SIMPLE) != 0)
+                goto error;
+            bufs[i].base = ctx->views[i].buf;
+            bufs[i].len = ctx->views[i].len;
+        }
+
+        ctx->callback = callback;
+        Py_INCREF(callback);
+
+        err = uv_udp_send(&ctx->req, &self->udp_h, bufs, buf_count, addr, (uv_udp_send_cb)pyuv__udp_send_cb);
+    }
+
+    if (err < 0) {
+        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
+        Py_DECREF(callback);
+        goto error;
+    }
+
+    /* Increase refcount so that object is not removed before the callback is called */
+    Py_INCREF(self);
+
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, self->udp_h.send_queue_size);
+
+    Py_DECREF(data_fast);
+    Py_RETURN_NONE;
+
+error:
+    for (j = 0; j < i; j++)
+        PyBuffer_Release(&ctx->views[j]);
+    if (ctx->views != ctx->viewsml)
+        PyMem_Free(ctx->views);
+    pyuv__req_put(HANDLE(self)->loop, &HANDLE(self)->loop->reqs.udp_send, ctx);
+    Py_XDECREF(data_fast);
+    return NULL;
+}
+
+
+static PyObject *
+UDP_func_send(UDP *self, PyObject *args, PyObject *kwargs)
+{
+    Py_ssize_t segment_size;
+    PyObject *addr, *callback, *data;
+    struct sockaddr_storage ss;
+
+    static char *kwlist[] = {"address", "data", "callback", "segment_size", NULL};
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    callback = Py_None;
+    segment_size = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|On:send", kwlist, &addr, &data, &callback, &segment_size)) {
+        return NULL;
+    }
+
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "'callback' must be a callable or None");
+        return NULL;
+    }
+
+    if (segment_size < 0 || segment_size > 65507) {
+        PyErr_SetString(PyExc_ValueError, "segment_size must be between 0 and 65507");
+        return NULL;
+    }
+
+    if (addr == Py_None) {
+        if (!self->connected) {
+            RAISE_UV_EXCEPTION(UV_ENOTCONN, PyExc_UDPError);
+            return NULL;
+        }
+        memcpy(&ss, &self->peer, sizeof(ss));
+    } else if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
+        /* Error is set by the function itself */
+        return NULL;
+    }
+
+    if (segment_size > 0) {
+        if (!PyObject_CheckBuffer(data)) {
+            PyErr_SetString(PyExc_TypeError, "only bytes are supported with segment_size");
+            return NULL;
+        }
+        return pyuv__udp_send_segmented(self, &ss, data, segment_size, callback);
+    } else if (PyObject_CheckBuffer(data)) {
+        if (addr == Py_None) {
+            return pyuv__udp_send_segmented(self, &ss, data, 0, callback);
+        }
+        return pyuv__udp_send_bytes(self, (struct sockaddr*) &ss, data, callback);
+    } else if (!PyUnicode_Check(data) && PySequence_Check(data)) {
+        return pyuv__udp_send_sequence(self, (struct sockaddr*) &ss, data, callback);
+    } else {
+        PyErr_SetString(PyExc_TypeError, "only bytes and sequences are supported");
+        return NULL;
+    }
+}
+
+
+/*
+ * Send many datagrams at once. On Linux as many as possible are sent right away with sendmmsg
+ * (only if nothing is queued, to keep ordering), whatever is left is queued with uv_udp_send.
+ * The callback is called once, with a list holding the error for each datagram (or None).
+ */
+static void
+pyuv__udp_send_many_free(udp_send_many_ctx *ctx)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < ctx->view_count; i++) {
+        PyBuffer_Release(&ctx->views[i]);
+    }
+    PyMem_Free(ctx->views);
+    PyMem_Free(ctx->addrs);
+    PyMem_Free(ctx->bufs);
+    PyMem_Free(ctx->reqs);
+    Py_XDECREF(ctx->callback);
+    Py_XDECREF(ctx->errors);
+    PyMem_Free(ctx);
+}
+
+
+static void
+pyuv__udp_send_many_complete(udp_send_many_ctx *ctx)
+{
+    Py_ssize_t i;
+    Loop *loop;
+    UDP *self;
+    PyObject *result, *errors;
+
+    self = ctx->udp;
+    loop = HANDLE(self)->loop;
+
+    if (ctx->callback != Py_None) {
+        errors = ctx->errors;
+        if (ctx->single) {
+            /* segmented send, report the first error */
+            errors = Py_None;
+            for (i = 0; i < ctx->count; i++) {
+                if (PyList_GET_ITEM(ctx->errors, i) != Py_None) {
+                    errors = PyList_GET_ITEM(ctx->errors, i);
+                    break;
+                }
+            }
+        }
+        result = PyObject_CallFunctionObjArgs(ctx->callback, self, errors, NULL);
+        if (result == NULL) {
+            handle_uncaught_exception(loop);
+        }
+        Py_XDECREF(result);
+    }
+
+    pyuv__udp_send_many_free(ctx);
+
+    if (!uv_is_closing(UV_HANDLE(self))) {
+        pyuv__watermarks_update(&self->watermarks, (PyObject *)self, loop, self->udp_h.send_queue_size);
+    }
+
+    /* Refcount was increased in the caller function */
+    Py_DECREF(self);
+}
+
+
+static void
+pyuv__udp_send_many_cb(uv_udp_send_t* req, int status)
+{
+    int gstate = pyuv__gil_ensure(req->handle->loop);
+    udp_send_many_req *r;
+    udp_send_many_ctx *ctx;
+    PyObject *py_errorno;
+
+    r = PYUV_CONTAINER_OF(req, udp_send_many_req, req);
+    ctx = r->ctx;
+
+    if (status < 0) {
+        py_errorno = PyInt_FromLong((long)status);
+        if (py_errorno != NULL) {
+            PyList_SetItem(ctx->errors, r->index, py_errorno);
+        } else {
+            PyErr_Clear();
+        }
+    }
+
+    if (--ctx->pending == 0) {
+        pyuv__udp_send_many_complete(ctx);
+    }
+
+    pyuv__gil_release(gstate);
 }
 
 
-static PyObject *
-UDP_func_bind(UDP *self, PyObject *args)
+/* Everything went out with sendmmsg, called from the loop deferred queue */
+static void
+pyuv__udp_send_many_deferred_cb(uv_write_t* req, int status)
 {
-    int err, flags;
-    struct sockaddr_storage ss;
-    PyObject *addr;
+    UNUSED_ARG(status);
 
-    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
-    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+    pyuv__udp_send_many_complete(PYUV_CONTAINER_OF(req, udp_send_many_ctx, deferred_req));
+}
 
-    flags = 0;
 
-    if (!PyArg_ParseTuple(args, "O|i:bind", &addr, &flags)) {
-        return NULL;
-    }
+static void
+pyuv__udp_send_many_set_error(udp_send_many_ctx *ctx, Py_ssize_t i, int err)
+{
+    PyObject *py_errorno;
 
-    if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
-        /* Error is set by the function itself */
-        return NULL;
+    py_errorno = PyInt_FromLong((long)err);
+    if (py_errorno == NULL) {
+        PyErr_Clear();
+        return;
     }
+    PyList_SetItem(ctx->errors, i, py_errorno);
+}
 
-    err = uv_udp_bind(&self->udp_h, (struct sockaddr *)&ss, flags);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
-        return NULL;
-    }
 
-    Py_RETURN_NONE;
+#ifdef __linux__
+/* Datagrams for the peer of a connected handle are sent without a destination, which saves
+ * the kernel a route lookup */
+static Bool
+pyuv__udp_is_peer(UDP *self, struct sockaddr_storage *ss)
+{
+    return self->connected && pyuv__sockaddr_equal((struct sockaddr *)ss, (struct sockaddr *)&self->peer);
 }
 
 
-static PyObject *
-UDP_func_start_recv(UDP *self, PyObject *args)
+/* Returns the number of datagrams dealt with, the rest need to be queued */
+static Py_ssize_t
+pyuv__udp_sendmmsg(UDP *self, udp_send_many_ctx *ctx)
 {
-    int err;
-    PyObject *tmp, *callback;
+    int r;
+    uv_os_fd_t fd;
+    Py_ssize_t i, j, n;
+    struct mmsghdr *msgs;
 
-    tmp = NULL;
+    if (ctx->count == 0 || self->udp_h.send_queue_count > 0 || uv_fileno(UV_HANDLE(self), &fd) < 0) {
+        return 0;
+    }
 
-    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
-    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+    n = ctx->count < PYUV_UDP_SENDMMSG_MAX ? ctx->count : PYUV_UDP_SENDMMSG_MAX;
+    msgs = PyMem_Malloc(sizeof(struct mmsghdr) * n);
+    if (msgs == NULL) {
+        return 0;
+    }
 
-    if (!PyArg_ParseTuple(args, "O:start_recv", &callback)) {
-        return NULL;
+    i = 0;
+    while (i < ctx->count) {
+        n = ctx->count - i;
+        if (n > PYUV_UDP_SENDMMSG_MAX) {
+            n = PYUV_UDP_SENDMMSG_MAX;
+        }
+        for (j = 0; j < n; j++) {
+            memset(&msgs[j], 0, sizeof(msgs[j]));
+            if (!pyuv__udp_is_peer(self, &ctx->addrs[i + j])) {
+                msgs[j].msg_hdr.msg_name = &ctx->addrs[i + j];
+                msgs[j].msg_hdr.msg_namelen = pyuv__sockaddr_len((struct sockaddr *)&ctx->addrs[i + j]);
+            }
+            /* uv_buf_t and struct iovec share the layout on Unix */
+            msgs[j].msg_hdr.msg_iov = (struct iovec *)&ctx->bufs[i + j];
+            msgs[j].msg_hdr.msg_iovlen = 1;
+        }
+
+        do {
+            r = sendmmsg(fd, msgs, (unsigned int)n, 0);
+        } while (r < 0 && errno == EINTR);
+
+        if (r < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                break;
+            }
+            /* the first datagram failed, skip it and go on */
+            pyuv__udp_send_many_set_error(ctx, i, -errno);
+            i++;
+            continue;
+        }
+        i += r;
     }
 
-    if (!PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "a callable is required");
-        return NULL;
+    PyMem_Free(msgs);
+    return i;
+}
+
+
+/*
+ * Segmented send using UDP_SEGMENT: consecutive segments (which point into the same buffer) go
+ * out in a single sendmsg call and the kernel splits them into datagrams. If GSO is not usable
+ * the rest is left to be sent as individual datagrams.
+ */
+static Py_ssize_t
+pyuv__udp_send_gso(UDP *self, udp_send_many_ctx *ctx)
+{
+    int r;
+    uint16_t segment_size;
+    uv_os_fd_t fd;
+    Py_ssize_t i, j, n, max_segments;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    char control[CMSG_SPACE(sizeof(uint16_t))];
+
+    if (ctx->count == 0 || self->udp_h.send_queue_count > 0 || uv_fileno(UV_HANDLE(self), &fd) < 0) {
+        return 0;
     }
 
-    err = uv_udp_recv_start(&self->udp_h, (uv_alloc_cb)pyuv__alloc_cb, (uv_udp_recv_cb)pyuv__udp_recv_cd);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
-        return NULL;
+    segment_size = (uint16_t)ctx->segment_size;
+    max_segments = PYUV_UDP_GSO_MAX_BYTES / segment_size;
+    if (max_segments > PYUV_UDP_GSO_MAX_SEGMENTS) {
+        max_segments = PYUV_UDP_GSO_MAX_SEGMENTS;
     }
 
-    tmp = self->on_read_cb;
-    Py_INCREF(callback);
-    self->on_read_cb = callback;
-    Py_XDECREF(tmp);
+    i = 0;
+    while (i < ctx->count) {
+        n = ctx->count - i;
+        if (n > max_segments) {
+            n = max_segments;
+        }
 
-    PYUV_HANDLE_INCREF(self);
+        iov.iov_base = ctx->bufs[i].base;
+        iov.iov_len = 0;
+        for (j = 0; j < n; j++) {
+            iov.iov_len += ctx->bufs[i + j].len;
+        }
 
-    Py_RETURN_NONE;
+        memset(&msg, 0, sizeof(msg));
+        if (!pyuv__udp_is_peer(self, &ctx->addrs[i])) {
+            msg.msg_name = &ctx->addrs[i];
+            msg.msg_namelen = pyuv__sockaddr_len((struct sockaddr *)&ctx->addrs[i]);
+        }
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (n > 1) {
+            memset(control, 0, sizeof(control));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(uint16_t));
+        }
+
+        do {
+            r = sendmsg(fd, &msg, 0);
+        } while (r < 0 && errno == EINTR);
+
+        if (r < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                break;
+            }
+            /* no GSO support in the kernel or the device, send the datagrams one by one */
+            if (n > 1 && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP)) {
+                break;
+            }
+            for (j = 0; j < n; j++) {
+                pyuv__udp_send_many_set_error(ctx, i + j, -errno);
+            }
+        }
+        i += n;
+    }
+
+    return i;
 }
+#endif
 
 
 static PyObject *
-UDP_func_stop_recv(UDP *self)
+pyuv__udp_send_many_submit(UDP *self, udp_send_many_ctx *ctx)
 {
     int err;
+    Py_ssize_t i, start;
 
-    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
-    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+    ctx->errors = PyList_New(ctx->count);
+    if (ctx->errors == NULL) {
+        goto error;
+    }
+    for (i = 0; i < ctx->count; i++) {
+        Py_INCREF(Py_None);
+        PyList_SET_ITEM(ctx->errors, i, Py_None);
+    }
 
-    err = uv_udp_recv_stop(&self->udp_h);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
-        return NULL;
+#ifdef __linux__
+    if (ctx->segment_size > 0) {
+        start = pyuv__udp_send_gso(self, ctx);
+    } else {
+        start = pyuv__udp_sendmmsg(self, ctx);
+    }
+#else
+    start = 0;
+#endif
+
+    if (start < ctx->count) {
+        ctx->reqs = PyMem_Malloc(sizeof(udp_send_many_req) * (ctx->count - start));
+        if (ctx->reqs == NULL) {
+            PyErr_NoMemory();
+            goto error;
+        }
     }
 
-    Py_XDECREF(self->on_read_cb);
-    self->on_read_cb = NULL;
+    for (i = start; i < ctx->count; i++) {
+        ctx->reqs[i - start].ctx = ctx;
+        ctx->reqs[i - start].index = i;
+        err = uv_udp_send(&ctx->reqs[i - start].req, &self->udp_h, &ctx->bufs[i], 1, (struct sockaddr *)&ctx->addrs[i], (uv_udp_send_cb)pyuv__udp_send_many_cb);
+        if (err < 0) {
+            pyuv__udp_send_many_set_error(ctx, i, err);
+        } else {
+            ctx->pending++;
+        }
+    }
 
-    PYUV_HANDLE_DECREF(self);
+    /* Increase refcount so that object is not removed before the callback is called */
+    Py_INCREF(self);
+    ctx->udp = self;
+
+    if (ctx->pending == 0) {
+        ctx->deferred_req.cb = (uv_write_cb)pyuv__udp_send_many_deferred_cb;
+        pyuv__loop_defer_write(HANDLE(self)->loop, &ctx->deferred_req);
+    } else {
+        pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, self->udp_h.send_queue_size);
+    }
 
     Py_RETURN_NONE;
+
+error:
+    pyuv__udp_send_many_free(ctx);
+    return NULL;
 }
 
 
-static PyObject *
-UDP_func_try_send(UDP *self, PyObject *args)
+static udp_send_many_ctx *
+pyuv__udp_send_many_new(Py_ssize_t count, Py_ssize_t view_count, PyObject *callback)
 {
-    int err;
-    uv_buf_t buf;
-    Py_buffer view;
-    PyObject *addr;
-    struct sockaddr_storage ss;
-
-    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
-    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+    udp_send_many_ctx *ctx;
 
-    if (!PyArg_ParseTuple(args, "O"PYUV_BYTES"*:try_send", &addr, &view)) {
+    ctx = PyMem_Malloc(sizeof *ctx);
+    if (ctx == NULL) {
+        PyErr_NoMemory();
         return NULL;
     }
+    memset(ctx, 0, sizeof *ctx);
 
-    if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
-        /* Error is set by the function itself */
-        PyBuffer_Release(&view);
-        return NULL;
-    }
+    Py_INCREF(callback);
+    ctx->callback = callback;
+    ctx->count = count;
 
-    buf = uv_buf_init(view.buf, view.len);
-    err = uv_udp_try_send(&self->udp_h, &buf, 1, (struct sockaddr*) &ss);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
-        PyBuffer_Release(&view);
+    /* allocate at least one entry, so empty lists don't look like allocation failures */
+    ctx->addrs = PyMem_Malloc(sizeof(struct sockaddr_storage) * (count > 0 ? count : 1));
+    ctx->bufs = PyMem_Malloc(sizeof(uv_buf_t) * (count > 0 ? count : 1));
+    ctx->views = PyMem_Malloc(sizeof(Py_buffer) * (view_count > 0 ? view_count : 1));
+    if (ctx->addrs == NULL || ctx->bufs == NULL || ctx->views == NULL) {
+        PyErr_NoMemory();
+        pyuv__udp_send_many_free(ctx);
         return NULL;
     }
 
-    PyBuffer_Release(&view);
-    return PyInt_FromLong((long)err);
+    return ctx;
 }
 
 
+/* Split data in segment_size datagrams, they are sent with GSO where possible. A segment_size
+ * of 0 sends a single datagram, which goes straight to the socket if nothing is queued. */
 static PyObject *
-pyuv__udp_send_bytes(UDP *self, struct sockaddr *addr, PyObject *data, PyObject *callback)
+pyuv__udp_send_segmented(UDP *self, struct sockaddr_storage *ss, PyObject *data, Py_ssize_t segment_size, PyObject *callback)
 {
-    int err;
-    uv_buf_t buf;
-    udp_send_ctx *ctx;
-    Py_buffer *view;
+    Py_ssize_t i, count;
+    Py_buffer view;
+    udp_send_many_ctx *ctx;
 
-    ctx = PyMem_Malloc(sizeof *ctx);
-    if (!ctx) {
-        PyErr_NoMemory();
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) != 0) {
         return NULL;
     }
 
-    ctx->views = ctx->viewsml;
-    view = &ctx->views[0];
-
-    if (PyObject_GetBuffer(data, view, PyBUF_SIMPLE) != 0) {
-        PyMem_Free(ctx);
+    count = segment_size > 0 && view.len > 0 ? (view.len + segment_size - 1) / segment_size : 1;
+    ctx = pyuv__udp_send_many_new(count, 1, callback);
+    if (ctx == NULL) {
+        PyBuffer_Release(&view);
         return NULL;
     }
 
+    memcpy(&ctx->views[0], &view, sizeof(Py_buffer));
     ctx->view_count = 1;
-    ctx->callback = callback;
-
-    Py_INCREF(callback);
-
-    buf = uv_buf_init(view->buf, view->len);
+    ctx->segment_size = (size_t)segment_size;
+    ctx->single = True;
 
-    err = uv_udp_send(&ctx->req, &self->udp_h, &buf, 1, addr, (uv_udp_send_cb)pyuv__udp_send_cb);
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
-        Py_DECREF(callback);
-        PyBuffer_Release(view);
-        PyMem_Free(ctx);
-        return NULL;
+    for (i = 0; i < count; i++) {
+        memcpy(&ctx->addrs[i], ss, sizeof(*ss));
+        ctx->bufs[i] = uv_buf_init((char *)view.buf + i * segment_size, (unsigned int)(i == count - 1 ? view.len - i * segment_size : segment_size));
     }
 
-    /* Increase refcount so that object is not removed before the callback is called */
-    Py_INCREF(self);
-
-    Py_RETURN_NONE;
+    return pyuv__udp_send_many_submit(self, ctx);
 }
 
 
 static PyObject *
-pyuv__udp_send_sequence(UDP *self, struct sockaddr *addr, PyObject *data, PyObject *callback)
+UDP_func_send_many(UDP *self, PyObject *args)
 {
-    int err;
-    udp_send_ctx *ctx;
-    PyObject *data_fast, *item;
-    Py_ssize_t i, j, buf_count;
+    Py_ssize_t i, count;
+    udp_send_many_ctx *ctx;
+    PyObject *datagrams, *datagrams_fast, *item, *addr, *data, *callback;
 
-    data_fast = PySequence_Fast(data, "data must be an iterable");
-    if (data_fast == NULL)
-        return NULL;
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
 
-    buf_count = PySequence_Fast_GET_SIZE(data_fast);
-    if (buf_count > INT_MAX) {
-        PyErr_SetString(PyExc_ValueError, "iterable is too long");
-        Py_DECREF(data_fast);
+    callback = Py_None;
+
+    if (!PyArg_ParseTuple(args, "O|O:send_many", &datagrams, &callback)) {
         return NULL;
     }
 
-    if (buf_count == 0) {
-        PyErr_SetString(PyExc_ValueError, "iterable is empty");
-        Py_DECREF(data_fast);
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "'callback' must be a callable or None");
         return NULL;
     }
 
-    ctx = PyMem_Malloc(sizeof *ctx);
-    if (!ctx) {
-        PyErr_NoMemory();
-        Py_DECREF(data_fast);
+    datagrams_fast = PySequence_Fast(datagrams, "datagrams must be an iterable");
+    if (datagrams_fast == NULL) {
         return NULL;
     }
 
-    ctx->views = ctx->viewsml;
-    if (buf_count > ARRAY_SIZE(ctx->viewsml))
-        ctx->views = PyMem_Malloc(sizeof(Py_buffer) * buf_count);
-    if (!ctx->views) {
-        PyErr_NoMemory();
-        PyMem_Free(ctx);
-        Py_DECREF(data_fast);
+    count = PySequence_Fast_GET_SIZE(datagrams_fast);
+    ctx = pyuv__udp_send_many_new(count, count, callback);
+    if (ctx == NULL) {
+        Py_DECREF(datagrams_fast);
         return NULL;
     }
-    ctx->view_count = buf_count;
-
-    {
-        STACK_ARRAY(uv_buf_t, bufs, buf_count);
 
-        for (i = 0; i < buf_count; i++) {
-            item = PySequence_Fast_GET_ITEM(data_fast, i);
-            if (PyObject_GetBuffer(item, &ctx->views[i], PyBUF_SIMPLE) != 0)
-                goto error;
-            bufs[i].base = ctx->views[i].buf;
-            bufs[i].len = ctx->views[i].len;
+    for (i = 0; i < count; i++) {
+        item = PySequence_Fast_GET_ITEM(datagrams_fast, i);
+        if (!PyTuple_Check(item) || !PyArg_ParseTuple(item, "OO:send_many", &addr, &data)) {
+            if (!PyErr_Occurred()) {
+                PyErr_SetString(PyExc_TypeError, "datagrams must be (address, data) tuples");
+            }
+            goto error;
         }
-
-        ctx->callback = callback;
-        Py_INCREF(callback);
-
-        err = uv_udp_send(&ctx->req, &self->udp_h, bufs, buf_count, addr, (uv_udp_send_cb)pyuv__udp_send_cb);
-    }
-
-    if (err < 0) {
-        RAISE_UV_EXCEPTION(err, PyExc_UDPError);
-        Py_DECREF(callback);
-        goto error;
+        if (pyuv_parse_addr_tuple(addr, &ctx->addrs[i]) < 0) {
+            goto error;
+        }
+        if (PyObject_GetBuffer(data, &ctx->views[i], PyBUF_SIMPLE) != 0) {
+            goto error;
+        }
+        ctx->view_count++;
+        ctx->bufs[i] = uv_buf_init(ctx->views[i].buf, (unsigned int)ctx->views[i].len);
     }
 
-    /* Increase refcount so that object is not removed before the callback is called */
-    Py_INCREF(self);
-
-    Py_RETURN_NONE;
+    Py_DECREF(datagrams_fast);
+    return pyuv__udp_send_many_submit(self, ctx);
 
 error:
-    for (j = 0; j < i; j++)
-        PyBuffer_Release(&ctx->views[j]);
-    if (ctx->views != ctx->viewsml)
-        PyMem_Free(ctx->views);
-    PyMem_Free(ctx);
-    Py_XDECREF(data_fast);
+    Py_DECREF(datagrams_fast);
+    pyuv__udp_send_many_free(ctx);
     return NULL;
 }
 
 
 static PyObject *
-UDP_func_send(UDP *self, PyObject *args)
+UDP_func_send_to_all(UDP *self, PyObject *args)
 {
-    PyObject *addr, *callback, *data;
-    struct sockaddr_storage ss;
+    Py_ssize_t i, count;
+    udp_send_many_ctx *ctx;
+    PyObject *addrs, *addrs_fast, *data, *callback;
 
     RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
     RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
 
     callback = Py_None;
 
-    if (!PyArg_ParseTuple(args, "OO|O:send", &addr, &data, &callback)) {
+    if (!PyArg_ParseTuple(args, "OO|O:send_to_all", &addrs, &data, &callback)) {
         return NULL;
     }
 
@@ -387,19 +1542,38 @@ UDP_func_send(UDP *self, PyObject *args)
         return NULL;
     }
 
-    if (pyuv_parse_addr_tuple(addr, &ss) < 0) {
-        /* Error is set by the function itself */
+    addrs_fast = PySequence_Fast(addrs, "addresses must be an iterable");
+    if (addrs_fast == NULL) {
         return NULL;
     }
 
-    if (PyObject_CheckBuffer(data)) {
-        return pyuv__udp_send_bytes(self, (struct sockaddr*) &ss, data, callback);
-    } else if (!PyUnicode_Check(data) && PySequence_Check(data)) {
-        return pyuv__udp_send_sequence(self, (struct sockaddr*) &ss, data, callback);
-    } else {
-        PyErr_SetString(PyExc_TypeError, "only bytes and sequences are supported");
+    count = PySequence_Fast_GET_SIZE(addrs_fast);
+    ctx = pyuv__udp_send_many_new(count, 1, callback);
+    if (ctx == NULL) {
+        Py_DECREF(addrs_fast);
         return NULL;
     }
+
+    if (PyObject_GetBuffer(data, &ctx->views[0], PyBUF_SIMPLE) != 0) {
+        goto error;
+    }
+    ctx->view_count = 1;
+
+    /* every datagram points to the same payload */
+    for (i = 0; i < count; i++) {
+        if (pyuv_parse_addr_tuple(PySequence_Fast_GET_ITEM(addrs_fast, i), &ctx->addrs[i]) < 0) {
+            goto error;
+        }
+        ctx->bufs[i] = uv_buf_init(ctx->views[0].buf, (unsigned int)ctx->views[0].len);
+    }
+
+    Py_DECREF(addrs_fast);
+    return pyuv__udp_send_many_submit(self, ctx);
+
+error:
+    Py_DECREF(addrs_fast);
+    pyuv__udp_send_many_free(ctx);
+    return NULL;
 }
 
 
@@ -726,6 +1900,31 @@ UDP_rcvbuf_set(UDP *self, PyObject *value, void *closure)
 }
 
 
+static PyObject *
+UDP_func_set_send_watermarks(UDP *self, PyObject *args)
+{
+    Py_ssize_t high, low;
+    PyObject *on_pause, *on_resume;
+
+    on_pause = on_resume = Py_None;
+
+    RAISE_IF_HANDLE_NOT_INITIALIZED(self, NULL);
+    RAISE_IF_HANDLE_CLOSED(self, PyExc_HandleClosedError, NULL);
+
+    if (!PyArg_ParseTuple(args, "nn|OO:set_send_watermarks", &high, &low, &on_pause, &on_resume)) {
+        return NULL;
+    }
+
+    if (pyuv__watermarks_set(&self->watermarks, high, low, on_pause, on_resume) < 0) {
+        return NULL;
+    }
+
+    pyuv__watermarks_update(&self->watermarks, (PyObject *)self, HANDLE(self)->loop, self->udp_h.send_queue_size);
+
+    Py_RETURN_NONE;
+}
+
+
 static PyObject *
 UDP_send_queue_size_get(UDP *self, void *closure)
 {
@@ -787,6 +1986,9 @@ static int
 UDP_tp_traverse(UDP *self, visitproc visit, void *arg)
 {
     Py_VISIT(self->on_read_cb);
+    Py_VISIT(self->watermarks.on_pause);
+    Py_VISIT(self->watermarks.on_resume);
+    Py_VISIT(self->batch.datagrams);
     return HandleType.tp_traverse((PyObject *)self, visit, arg);
 }
 
@@ -794,7 +1996,16 @@ UDP_tp_traverse(UDP *self, visitproc visit, void *arg)
 static int
 UDP_tp_clear(UDP *self)
 {
+    int i;
+
     Py_CLEAR(self->on_read_cb);
+    Py_CLEAR(self->watermarks.on_pause);
+    Py_CLEAR(self->watermarks.on_resume);
+    Py_CLEAR(self->batch.datagrams);
+    for (i = 0; i < PYUV_UDP_PEER_CACHE_SIZE; i++) {
+        Py_CLEAR(self->peers[i]);
+    }
+    Py_CLEAR(self->peer_address);
     return HandleType.tp_clear((PyObject *)self);
 }
 
@@ -802,11 +2013,16 @@ UDP_tp_clear(UDP *self)
 static PyMethodDef
 UDP_tp_methods[] = {
     { "bind", (PyCFunction)UDP_func_bind, METH_VARARGS, "Bind to the specified IP and port." },
-    { "start_recv", (PyCFunction)UDP_func_start_recv, METH_VARARGS, "Start accepting data." },
+    { "connect", (PyCFunction)UDP_func_connect, METH_VARARGS, "Connect to the specified IP and port." },
+    { "start_recv", (PyCFunction)UDP_func_start_recv, METH_VARARGS | METH_KEYWORDS, "Start accepting data." },
     { "stop_recv", (PyCFunction)UDP_func_stop_recv, METH_NOARGS, "Stop receiving data." },
     { "try_send", (PyCFunction)UDP_func_try_send, METH_VARARGS, "Try to send data over UDP." },
-    { "send", (PyCFunction)UDP_func_send, METH_VARARGS, "Send data over UDP." },
+    { "set_send_watermarks", (PyCFunction)UDP_func_set_send_watermarks, METH_VARARGS, "Set the send queue watermarks used for flow control." },
+    { "send", (PyCFunction)UDP_func_send, METH_VARARGS | METH_KEYWORDS, "Send data over UDP." },
+    { "send_many", (PyCFunction)UDP_func_send_many, METH_VARARGS, "Send many datagrams at once." },
+    { "send_to_all", (PyCFunction)UDP_func_send_to_all, METH_VARARGS, "Send the same datagram to many addresses at once." },
     { "getsockname", (PyCFunction)UDP_func_getsockname, METH_NOARGS, "Get local socket information." },
+    { "getpeername", (PyCFunction)UDP_func_getpeername, METH_NOARGS, "Get the address the handle is connected to." },
     { "open", (PyCFunction)UDP_func_open, METH_VARARGS, "Open the specified file descriptor and manage it as a UDP handle." },
     { "set_membership", (PyCFunction)UDP_func_set_membership, METH_VARARGS, "Set membership for multicast address." },
     { "set_multicast_interface", (PyCFunction)UDP_func_set_multicast_interface, METH_VARARGS, "Set the multicast interface." },
@@ -0,0 +1,599 @@
+/*
+ * Optional io_uring backend for the fs module, Linux only.
+ *
+ * Operations are queued in the submission ring while Python code runs and submitted with a
+ * single io_uring_enter call from a prepare handle, right before the loop polls for i/o.
+ * Completions are signaled through an eventfd which is watched by a poll handle, and then
+ * delivered through pyuv__process_fs_req, exactly like the ones coming from the threadpool.
+ * If the ring can't be set up, or any of the required operations is not supported by the
+ * kernel, everything keeps going through the threadpool.
+ */
+
+#ifdef PYUV_HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#define PYUV_URING_ENTRIES 256
+
+typedef struct {
+    FSRequest *fs_req;
+    char *path;
+    Bool has_statx;
+    struct statx statxbuf;
+    unsigned int niov;
+    struct iovec iov[1];
+} pyuv_uring_op;
+
+struct pyuv_uring_s {
+    int fd;
+    int event_fd;
+    unsigned int sq_entries;
+    unsigned int cq_entries;
+    unsigned int sq_tail;
+    unsigned int *sq_khead;
+    unsigned int *sq_ktail;
+    unsigned int *sq_kmask;
+    unsigned int *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned int *cq_khead;
+    unsigned int *cq_ktail;
+    unsigned int *cq_kmask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned int pending;
+    unsigned int inflight;
+    unsigned int closing;
+    Bool enabled;
+    uv_prepare_t prepare_h;
+    uv_poll_t poll_h;
+};
+
+
+static void
+pyuv__uring_unmap(pyuv_uring_t *ring)
+{
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL && ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->event_fd != -1) {
+        close(ring->event_fd);
+    }
+    if (ring->fd != -1) {
+        close(ring->fd);
+    }
+}
+
+
+static int
+pyuv__uring_probe(pyuv_uring_t *ring)
+{
+    static const int required[] = {
+        IORING_OP_READV,
+        IORING_OP_WRITEV,
+        IORING_OP_FSYNC,
+        IORING_OP_OPENAT,
+        IORING_OP_CLOSE,
+        IORING_OP_STATX
+    };
+    struct io_uring_probe *probe;
+    size_t i, size;
+    int r;
+
+    size = sizeof(*probe) + 256 * sizeof(struct io_uring_probe_op);
+    probe = malloc(size);
+    if (!probe) {
+        return UV_ENOMEM;
+    }
+    memset(probe, 0, size);
+
+    r = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256);
+    if (r < 0) {
+        r = -errno;
+        goto end;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(required); i++) {
+        if (required[i] > probe->last_op || !(probe->ops[required[i]].flags & IO_URING_OP_SUPPORTED)) {
+            r = UV_ENOSYS;
+            goto end;
+        }
+    }
+    r = 0;
+
+end:
+    free(probe);
+    return r;
+}
+
+
+static int
+pyuv__uring_setup(pyuv_uring_t *ring)
+{
+    struct io_uring_params p;
+    char *sq, *cq;
+    int r;
+
+    memset(&p, 0, sizeof p);
+    ring->fd = -1;
+    ring->event_fd = -1;
+
+    ring->fd = syscall(__NR_io_uring_setup, PYUV_URING_ENTRIES, &p);
+    if (ring->fd < 0) {
+        return -errno;
+    }
+
+    /* Completions must never be dropped, and the rings must be mappable at once */
+    if (!(p.features & IORING_FEAT_NODROP) || !(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        return UV_ENOSYS;
+    }
+
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (ring->cq_ring_size > ring->sq_ring_size) {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        return -errno;
+    }
+    ring->cq_ring = ring->sq_ring;
+
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        return -errno;
+    }
+
+    sq = ring->sq_ring;
+    cq = ring->cq_ring;
+    ring->sq_entries = p.sq_entries;
+    ring->cq_entries = p.cq_entries;
+    ring->sq_khead = (unsigned int *)(sq + p.sq_off.head);
+    ring->sq_ktail = (unsigned int *)(sq + p.sq_off.tail);
+    ring->sq_kmask = (unsigned int *)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *)(sq + p.sq_off.array);
+    ring->sq_tail = *ring->sq_ktail;
+    ring->cq_khead = (unsigned int *)(cq + p.cq_off.head);
+    ring->cq_ktail = (unsigned int *)(cq + p.cq_off.tail);
+    ring->cq_kmask = (unsigned int *)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    r = pyuv__uring_probe(ring);
+    if (r < 0) {
+        return r;
+    }
+
+    ring->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ring->event_fd < 0) {
+        return -errno;
+    }
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_EVENTFD, &ring->event_fd, 1) < 0) {
+        return -errno;
+    }
+
+    return 0;
+}
+
+
+static void
+pyuv__uring_statx_to_stat(const struct statx *stx, uv_stat_t *st)
+{
+    memset(st, 0, sizeof *st);
+    st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+    st->st_mode = stx->stx_mode;
+    st->st_nlink = stx->stx_nlink;
+    st->st_uid = stx->stx_uid;
+    st->st_gid = stx->stx_gid;
+    st->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+    st->st_ino = stx->stx_ino;
+    st->st_size = stx->stx_size;
+    st->st_blksize = stx->stx_blksize;
+    st->st_blocks = stx->stx_blocks;
+    st->st_atim.tv_sec = stx->stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+    st->st_birthtim.tv_sec = stx->stx_btime.tv_sec;
+    st->st_birthtim.tv_nsec = stx->stx_btime.tv_nsec;
+}
+
+
+static void
+pyuv__uring_handle_close_cb(uv_handle_t *handle)
+{
+    pyuv_uring_t *ring;
+
+    /* loop->uring is already cleared, find the ring from the embedded handle */
+    if (handle->type == UV_PREPARE) {
+        ring = PYUV_CONTAINER_OF(handle, pyuv_uring_t, prepare_h);
+    } else {
+        ring = PYUV_CONTAINER_OF(handle, pyuv_uring_t, poll_h);
+    }
+
+    if (--ring->closing == 0) {
+        pyuv__uring_unmap(ring);
+        free(ring);
+    }
+}
+
+
+/* Close the ring, returns the number of internal handles which are being closed */
+static int
+pyuv__uring_close(Loop *loop)
+{
+    pyuv_uring_t *ring = loop->uring;
+
+    if (ring == NULL) {
+        return 0;
+    }
+
+    ASSERT(ring->pending == 0 && ring->inflight == 0);
+    loop->uring = NULL;
+    ring->closing = 2;
+    uv_close((uv_handle_t *)&ring->prepare_h, pyuv__uring_handle_close_cb);
+    uv_close((uv_handle_t *)&ring->poll_h, pyuv__uring_handle_close_cb);
+    return 2;
+}
+
+
+static void
+pyuv__uring_submit_pending(pyuv_uring_t *ring)
+{
+    unsigned int n;
+    int r;
+
+    while (ring->pending > 0) {
+        /* Never have more operations in flight than the completion queue can hold, so it
+         * doesn't overflow. The rest is submitted as completions are reaped. */
+        n = ring->cq_entries - ring->inflight;
+        if (n == 0) {
+            break;
+        }
+        if (n > ring->pending) {
+            n = ring->pending;
+        }
+        r = syscall(__NR_io_uring_enter, ring->fd, n, 0, 0, NULL, 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* Out of resources (EAGAIN / EBUSY), try again on the next iteration */
+            break;
+        }
+        ring->pending -= r;
+        ring->inflight += r;
+    }
+
+    if (ring->pending == 0) {
+        uv_prepare_stop(&ring->prepare_h);
+    }
+}
+
+
+static void
+pyuv__uring_prepare_cb(uv_prepare_t *handle)
+{
+    pyuv_uring_t *ring = PYUV_CONTAINER_OF(handle, pyuv_uring_t, prepare_h);
+
+    pyuv__uring_submit_pending(ring);
+}
+
+
+static void
+pyuv__uring_complete(pyuv_uring_op *op, int res)
+{
+    FSRequest *fs_req;
+    uv_fs_t *req;
+
+    fs_req = op->fs_req;
+    req = &fs_req->req;
+    req->result = res;
+    if (res >= 0 && op->has_statx) {
+        pyuv__uring_statx_to_stat(&op->statxbuf, &req->statbuf);
+    }
+
+    pyuv__process_fs_req(req);
+
+    PyMem_Free(op->path);
+    PyMem_Free(op);
+}
+
+
+static void
+pyuv__uring_poll_cb(uv_poll_t *handle, int status, int events)
+{
+    int gstate = pyuv__gil_ensure(handle->loop);
+    Loop *loop;
+    pyuv_uring_t *ring;
+    pyuv_uring_op *op;
+    struct io_uring_cqe *cqe;
+    unsigned int head;
+    uint64_t value;
+    int res;
+
+    UNUSED_ARG(status);
+    UNUSED_ARG(events);
+
+    ring = PYUV_CONTAINER_OF(handle, pyuv_uring_t, poll_h);
+    loop = handle->loop->data;
+
+    if (read(ring->event_fd, &value, sizeof value) < 0) {
+        /* nothing to do, the eventfd is non-blocking */
+    }
+
+    head = *ring->cq_khead;
+    while (head != __atomic_load_n(ring->cq_ktail, __ATOMIC_ACQUIRE)) {
+        cqe = &ring->cqes[head & *ring->cq_kmask];
+        op = (pyuv_uring_op *)(uintptr_t)cqe->user_data;
+        res = cqe->res;
+        head++;
+        __atomic_store_n(ring->cq_khead, head, __ATOMIC_RELEASE);
+        ring->inflight--;
+        /* The callback may submit new operations */
+        pyuv__uring_complete(op, res);
+    }
+
+    /* Submissions which didn't fit before can go now */
+    if (ring->pending > 0) {
+        pyuv__uring_submit_pending(ring);
+    }
+
+    if (ring->inflight == 0 && ring->pending == 0) {
+        uv_poll_stop(&ring->poll_h);
+        if (!ring->enabled) {
+            pyuv__uring_close(loop);
+        }
+    }
+
+    pyuv__gil_release(gstate);
+}
+
+
+static int
+pyuv__uring_enable(Loop *loop)
+{
+    pyuv_uring_t *ring;
+    int r;
+
+    if (loop->uring != NULL) {
+        loop->uring->enabled = True;
+        return 0;
+    }
+
+    ring = malloc(sizeof *ring);
+    if (!ring) {
+        return UV_ENOMEM;
+    }
+    memset(ring, 0, sizeof *ring);
+
+    r = pyuv__uring_setup(ring);
+    if (r < 0) {
+        pyuv__uring_unmap(ring);
+        free(ring);
+        return r;
+    }
+
+    uv_prepare_init(loop->uv_loop, &ring->prepare_h);
+    uv_poll_init(loop->uv_loop, &ring->poll_h, ring->event_fd);
+    ring->prepare_h.data = NULL;
+    ring->poll_h.data = NULL;
+    ring->enabled = True;
+    loop->uring = ring;
+
+    return 0;
+}
+
+
+static void
+pyuv__uring_disable(Loop *loop)
+{
+    pyuv_uring_t *ring = loop->uring;
+
+    if (ring == NULL) {
+        return;
+    }
+
+    /* Operations in flight still complete through the ring, it's closed once they are done */
+    ring->enabled = False;
+    if (ring->pending == 0 && ring->inflight == 0) {
+        pyuv__uring_close(loop);
+    }
+}
+
+
+/* The ring may outlive a disable while operations are in flight, it's not used for new ones */
+static Bool
+pyuv__uring_enabled(Loop *loop)
+{
+    return loop->uring != NULL && loop->uring->enabled;
+}
+
+
+/*
+ * Queue a fs operation in the ring. Returns 0 if the operation was queued, in which case the
+ * result is delivered through pyuv__process_fs_req, or -1 if the threadpool has to be used.
+ * The caller keeps a reference to fs_req for the callback, like with the threadpool.
+ */
+static int
+pyuv__uring_submit(Loop *loop, FSRequest *fs_req, uv_fs_type type, uv_file fd, const char *path, int flags, int mode, const uv_buf_t *bufs, unsigned int nbufs, int64_t offset)
+{
+    pyuv_uring_t *ring;
+    pyuv_uring_op *op;
+    struct io_uring_sqe *sqe;
+    unsigned int i, idx;
+    size_t path_len;
+
+    ring = loop->uring;
+    if (ring == NULL || !ring->enabled) {
+        return -1;
+    }
+
+    if (ring->sq_tail - __atomic_load_n(ring->sq_khead, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+        pyuv__uring_submit_pending(ring);
+        if (ring->sq_tail - __atomic_load_n(ring->sq_khead, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+            return -1;
+        }
+    }
+
+    op = PyMem_Malloc(sizeof *op + (nbufs > 1 ? (nbufs - 1) * sizeof(struct iovec) : 0));
+    if (!op) {
+        return -1;
+    }
+    op->fs_req = fs_req;
+    op->path = NULL;
+    op->has_statx = False;
+    op->niov = nbufs;
+    for (i = 0; i < nbufs; i++) {
+        op->iov[i].iov_base = bufs[i].base;
+        op->iov[i].iov_len = bufs[i].len;
+    }
+    if (path != NULL) {
+        path_len = strlen(path) + 1;
+        op->path = PyMem_Malloc(path_len);
+        if (!op->path) {
+            PyMem_Free(op);
+            return -1;
+        }
+        memcpy(op->path, path, path_len);
+    }
+
+    idx = ring->sq_tail & *ring->sq_kmask;
+    sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof *sqe);
+    sqe->user_data = (uint64_t)(uintptr_t)op;
+
+    switch (type) {
+        case UV_FS_OPEN:
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (uint64_t)(uintptr_t)op->path;
+            sqe->len = mode;
+            sqe->open_flags = flags | O_CLOEXEC;
+            break;
+        case UV_FS_CLOSE:
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = fd;
+            break;
+        case UV_FS_READ:
+        case UV_FS_WRITE:
+            sqe->opcode = type == UV_FS_READ ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->fd = fd;
+            sqe->addr = (uint64_t)(uintptr_t)op->iov;
+            sqe->len = nbufs;
+            sqe->off = (uint64_t)offset;
+            break;
+        case UV_FS_FSYNC:
+        case UV_FS_FDATASYNC:
+            sqe->opcode = IORING_OP_FSYNC;
+            sqe->fd = fd;
+            sqe->fsync_flags = type == UV_FS_FDATASYNC ? IORING_FSYNC_DATASYNC : 0;
+            break;
+        case UV_FS_STAT:
+        case UV_FS_LSTAT:
+        case UV_FS_FSTAT:
+            op->has_statx = True;
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = type == UV_FS_FSTAT ? fd : AT_FDCWD;
+            sqe->addr = (uint64_t)(uintptr_t)(type == UV_FS_FSTAT ? "" : op->path);
+            sqe->len = STATX_BASIC_STATS | STATX_BTIME;
+            sqe->off = (uint64_t)(uintptr_t)&op->statxbuf;
+            sqe->statx_flags = type == UV_FS_LSTAT ? AT_SYMLINK_NOFOLLOW : (type == UV_FS_FSTAT ? AT_EMPTY_PATH : 0);
+            break;
+        default:
+            ASSERT(!"unsupported io_uring fs operation");
+            break;
+    }
+
+    ring->sq_array[idx] = idx;
+    ring->sq_tail++;
+    __atomic_store_n(ring->sq_ktail, ring->sq_tail, __ATOMIC_RELEASE);
+
+    /* Fill the request the same way libuv does, without going through it */
+    fs_req->req.type = UV_FS;
+    fs_req->req.fs_type = type;
+    fs_req->req.loop = loop->uv_loop;
+    fs_req->req.path = op->path;
+    fs_req->req.ptr = NULL;
+    fs_req->req.cb = NULL;
+    fs_req->req.result = 0;
+    /* There is no way to cancel it */
+    UV_REQUEST(fs_req) = NULL;
+
+    if (ring->pending++ == 0) {
+        uv_prepare_start(&ring->prepare_h, pyuv__uring_prepare_cb);
+    }
+    if (!uv_is_active((uv_handle_t *)&ring->poll_h)) {
+        uv_poll_start(&ring->poll_h, UV_READABLE, pyuv__uring_poll_cb);
+    }
+
+    return 0;
+}
+
+#else
+
+static int
+pyuv__uring_close(Loop *loop)
+{
+    UNUSED_ARG(loop);
+    return 0;
+}
+
+
+static int
+pyuv__uring_enable(Loop *loop)
+{
+    UNUSED_ARG(loop);
+    return UV_ENOSYS;
+}
+
+
+static void
+pyuv__uring_disable(Loop *loop)
+{
+    UNUSED_ARG(loop);
+}
+
+
+static Bool
+pyuv__uring_enabled(Loop *loop)
+{
+    UNUSED_ARG(loop);
+    return False;
+}
+
+
+static int
+pyuv__uring_submit(Loop *loop, FSRequest *fs_req, uv_fs_type type, uv_file fd, const char *path, int flags, int mode, const uv_buf_t *bufs, unsigned int nbufs, int64_t offset)
+{
+    UNUSED_ARG(loop);
+    UNUSED_ARG(fs_req);
+    UNUSED_ARG(type);
+    UNUSED_ARG(fd);
+    UNUSED_ARG(path);
+    UNUSED_ARG(flags);
+    UNUSED_ARG(mode);
+    UNUSED_ARG(bufs);
+    UNUSED_ARG(nbufs);
+    UNUSED_ARG(offset);
+    return -1;
+}
+
+#endif
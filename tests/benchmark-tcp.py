@@ -33,6 +33,7 @@ def on_read(client, data, error):
 def on_connection(server, error):
     client = pyuv.TCP(server.loop)
     server.accept(client)
+    client.eager_write = True
     clients.append(client)
     client.start_read(on_read)
 
@@ -2,6 +2,8 @@
 import os
 import shutil
 import stat
+import sys
+import threading
 import unittest
 
 from common import TestCase
@@ -534,6 +536,25 @@ class FSTestRead(FileTestCase):
         self.assertEqual(data, b'1234')
 
 
+@unittest.skipIf(os.name == 'nt', 'pipes do not block the same way on Windows')
+class FSTestSyncReleasesGIL(TestCase):
+
+    def test_sync_read_releases_gil(self):
+        self.data = None
+        rfd, wfd = os.pipe()
+        def reader():
+            self.data = pyuv.fs.read(self.loop, rfd, 4, -1)
+        t = threading.Thread(target=reader)
+        t.start()
+        # If the read held the GIL while blocked this thread could never write
+        while t.is_alive():
+            os.write(wfd, b"TEST")
+            t.join(0.01)
+        os.close(rfd)
+        os.close(wfd)
+        self.assertEqual(self.data, b"TEST")
+
+
 class FSTestWrite(TestCase):
 
     def setUp(self):
@@ -585,6 +606,456 @@ class FSTestWrite(TestCase):
             self.assertEqual(fobj.read(), "TEST")
 
 
+class FSTestVectored(TestCase):
+
+    def setUp(self):
+        super(FSTestVectored, self).setUp()
+        self.fd = pyuv.fs.open(self.loop, TEST_FILE, os.O_RDWR|os.O_CREAT|os.O_TRUNC, stat.S_IWRITE|stat.S_IREAD)
+
+    def tearDown(self):
+        pyuv.fs.close(self.loop, self.fd)
+        os.remove(TEST_FILE)
+        super(FSTestVectored, self).tearDown()
+
+    def test_writev_readinto(self):
+        self.bytes_written = None
+        self.bytes_read = None
+        buf1 = bytearray(4)
+        buf2 = bytearray(6)
+        def readinto_cb(req):
+            self.assertEqual(req.error, None)
+            self.bytes_read = req.result
+        def writev_cb(req):
+            self.assertEqual(req.error, None)
+            self.bytes_written = req.result
+            pyuv.fs.readinto(self.loop, self.fd, [buf1, memoryview(buf2)], 0, readinto_cb)
+        pyuv.fs.writev(self.loop, self.fd, [b"TEST", bytearray(b"12"), memoryview(b"3456")], 0, writev_cb)
+        self.loop.run()
+        self.assertEqual(self.bytes_written, 10)
+        self.assertEqual(self.bytes_read, 10)
+        self.assertEqual(buf1, b"TEST")
+        self.assertEqual(buf2, b"123456")
+
+    def test_writev_readinto_sync(self):
+        self.assertEqual(pyuv.fs.writev(self.loop, self.fd, [b"TEST", b"1234"], 4), 8)
+        buf = bytearray(16)
+        self.assertEqual(pyuv.fs.readinto(self.loop, self.fd, buf, 6), 6)
+        self.assertEqual(buf[:6], b"ST1234")
+        self.assertEqual(pyuv.fs.readinto(self.loop, self.fd, [buf], 100), 0)
+
+    def test_writev_readinto_errors(self):
+        self.assertRaises(BufferError, pyuv.fs.readinto, self.loop, self.fd, [b"readonly"], 0)
+        self.assertRaises(TypeError, pyuv.fs.writev, self.loop, self.fd, [b"TEST", 1], 0)
+        self.assertRaises(ValueError, pyuv.fs.writev, self.loop, self.fd, [], 0)
+        self.assertRaises(pyuv.error.FSError, pyuv.fs.readinto, self.loop, -1, bytearray(4), 0)
+
+
+class FSTestWholeFile(TestCase):
+
+    def tearDown(self):
+        for f in os.listdir('.'):
+            if f.startswith(TEST_FILE):
+                os.remove(f)
+        super(FSTestWholeFile, self).tearDown()
+
+    def test_write_file_read_file(self):
+        self.results = []
+        data = os.urandom(256 * 1024)
+        def read_cb(req):
+            self.assertEqual(req.error, None)
+            self.assertEqual(req.path, TEST_FILE)
+            self.results.append(req.result)
+        def write_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append(req.result)
+            pyuv.fs.read_file(self.loop, TEST_FILE, read_cb)
+        pyuv.fs.write_file(self.loop, TEST_FILE, data, callback=write_cb)
+        self.loop.run()
+        self.assertEqual(self.results, [len(data), data])
+
+    def test_write_file_atomic(self):
+        with open(TEST_FILE, 'wb') as f:
+            f.write(b"old contents")
+        self.error = None
+        def write_cb(req):
+            self.error = req.error
+        pyuv.fs.write_file(self.loop, TEST_FILE, b"new", fsync=True, atomic=True, callback=write_cb)
+        self.loop.run()
+        self.assertEqual(self.error, None)
+        self.assertEqual(pyuv.fs.read_file(self.loop, TEST_FILE), b"new")
+        self.assertEqual([f for f in os.listdir('.') if f.startswith(TEST_FILE)], [TEST_FILE])
+
+    def test_write_file_read_file_sync(self):
+        self.assertEqual(pyuv.fs.write_file(self.loop, TEST_FILE, b"TEST"), 4)
+        self.assertEqual(pyuv.fs.write_file(self.loop, TEST_FILE, b"1234", os.O_WRONLY|os.O_APPEND), 4)
+        self.assertEqual(pyuv.fs.read_file(self.loop, TEST_FILE), b"TEST1234")
+        self.assertEqual(pyuv.fs.write_file(self.loop, TEST_FILE, b""), 0)
+        self.assertEqual(pyuv.fs.read_file(self.loop, TEST_FILE), b"")
+
+    def test_read_file_error(self):
+        self.error = None
+        def read_cb(req):
+            self.error = req.error
+            self.assertEqual(req.result, None)
+        pyuv.fs.read_file(self.loop, BAD_FILE, read_cb)
+        self.loop.run()
+        self.assertEqual(self.error, pyuv.errno.UV_ENOENT)
+        self.assertRaises(pyuv.error.FSError, pyuv.fs.read_file, self.loop, BAD_FILE)
+
+
+class FSTestBatch(TestCase):
+
+    def setUp(self):
+        super(FSTestBatch, self).setUp()
+        os.mkdir(TEST_DIR)
+        self.files = [os.path.join(TEST_DIR, 'file%d' % i) for i in range(100)]
+        for f in self.files:
+            open(f, 'w').close()
+
+    def tearDown(self):
+        shutil.rmtree(TEST_DIR)
+        super(FSTestBatch, self).tearDown()
+
+    def test_batch(self):
+        self.progress = []
+        self.results = []
+        def progress_cb(completed, total):
+            self.progress.append((completed, total))
+        def batch_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append(req.result)
+            if len(self.results) == 1:
+                # chunks run concurrently, so the unlinks go in a batch of their own
+                pyuv.fs.batch(self.loop, [('unlink', (f,)) for f in self.files], batch_cb, chunk_size=16)
+        pyuv.fs.batch(self.loop, [('stat', (f,)) for f in self.files], batch_cb, progress_cb, chunk_size=16)
+        self.loop.run()
+        self.assertEqual(len(self.results), 2)
+        self.assertEqual(len(self.progress), 7)
+        self.assertEqual(sorted(self.progress)[-1], (100, 100))
+        self.assertEqual(len(self.results[0]), 100)
+        for r, err in self.results[0]:
+            self.assertEqual(err, None)
+            self.assertTrue(stat.S_ISREG(r.st_mode))
+        self.assertEqual(self.results[1], [(None, None)] * 100)
+        self.assertEqual(pyuv.fs.batch(self.loop, [('stat', (self.files[0],))]), [(None, pyuv.errno.UV_ENOENT)])
+        self.assertEqual(os.listdir(TEST_DIR), [])
+
+    def test_batch_sync(self):
+        new_dir = os.path.join(TEST_DIR, 'dir')
+        results = pyuv.fs.batch(self.loop, [('mkdir', (new_dir, 0o755)), ('rename', (self.files[0], self.files[0] + '_new')), ('rmdir', (new_dir,)), ('access', (self.files[0], os.F_OK))])
+        self.assertEqual(results, [(None, None), (None, None), (None, None), (None, pyuv.errno.UV_ENOENT)])
+        self.assertTrue(os.path.exists(self.files[0] + '_new'))
+
+    def test_batch_empty(self):
+        self.results = None
+        def batch_cb(req):
+            self.results = req.result
+        pyuv.fs.batch(self.loop, [], batch_cb)
+        self.loop.run()
+        self.assertEqual(self.results, [])
+
+    def test_batch_errors(self):
+        self.assertRaises(ValueError, pyuv.fs.batch, self.loop, [('truncate', (self.files[0],))])
+        self.assertRaises(TypeError, pyuv.fs.batch, self.loop, [('stat', self.files[0])])
+        self.assertRaises(TypeError, pyuv.fs.batch, self.loop, [('rename', (self.files[0],))])
+        self.assertRaises(ValueError, pyuv.fs.batch, self.loop, [], chunk_size=0)
+
+
+class FSTestWalk(TestCase):
+
+    def setUp(self):
+        super(FSTestWalk, self).setUp()
+        self.expected = {}
+        for d in ('a', 'a/b', 'a/b/c', 'd'):
+            os.makedirs(os.path.join(TEST_DIR, d))
+        for f in ('f1', 'a/f2', 'a/b/f3', 'a/b/c/f4'):
+            with open(os.path.join(TEST_DIR, f), 'w') as fobj:
+                fobj.write(f)
+
+    def tearDown(self):
+        shutil.rmtree(TEST_DIR)
+        super(FSTestWalk, self).tearDown()
+
+    def walk(self, root, **kwargs):
+        self.walked = {}
+        self.errors = {}
+        self.finished = 0
+        def walk_cb(path, entries, error):
+            if path is None:
+                self.finished += 1
+                return
+            if error is not None:
+                self.errors[path] = error
+                return
+            self.walked[path] = entries
+        pyuv.fs.walk(self.loop, root, walk_cb, **kwargs)
+        self.loop.run()
+        self.assertEqual(self.finished, 1)
+
+    def test_walk(self):
+        self.walk(TEST_DIR, max_parallel=2)
+        self.assertEqual(self.errors, {})
+        self.assertEqual(sorted(self.walked.keys()), sorted([TEST_DIR] + [os.path.join(TEST_DIR, d) for d in ('a', 'a/b', 'a/b/c', 'd')]))
+        names = sorted((e.name, e.type) for e in self.walked[os.path.join(TEST_DIR, 'a')])
+        self.assertEqual(names, [('b', pyuv.fs.UV_DIRENT_DIR), ('f2', pyuv.fs.UV_DIRENT_FILE)])
+        self.assertEqual(self.walked[os.path.join(TEST_DIR, 'd')], [])
+        for entries in self.walked.values():
+            for e in entries:
+                self.assertEqual(e.stat, None)
+
+    def test_walk_stat(self):
+        self.walk(TEST_DIR, stat=True)
+        entry = [e for e in self.walked[os.path.join(TEST_DIR, 'a/b/c')] if e.name == 'f4'][0]
+        self.assertEqual(entry.stat.st_size, len("a/b/c/f4"))
+
+    @unittest.skipIf(os.name == 'nt', 'symlinks need privileges on Windows')
+    def test_walk_follow_symlinks(self):
+        os.symlink(os.path.abspath(os.path.join(TEST_DIR, 'a')), os.path.join(TEST_DIR, 'a/b/c/loop'))
+        self.walk(TEST_DIR)
+        self.assertEqual(len(self.walked), 5)
+        self.walk(TEST_DIR, follow_symlinks=True)
+        # the symlink is followed once, then the cycle is detected
+        loop_entry = [e for e in self.walked[os.path.join(TEST_DIR, 'a/b/c')] if e.name == 'loop'][0]
+        self.assertEqual(loop_entry.type, pyuv.fs.UV_DIRENT_DIR)
+        self.assertEqual(len(self.walked), 5)
+
+    def test_walk_error(self):
+        self.walk(BAD_DIR)
+        self.assertEqual(self.walked, {})
+        self.assertEqual(self.errors, {BAD_DIR: pyuv.errno.UV_ENOENT})
+        self.assertRaises(ValueError, pyuv.fs.walk, self.loop, TEST_DIR, lambda *args: None, max_parallel=0)
+
+
+class FSTestIOUring(TestCase):
+
+    def setUp(self):
+        super(FSTestIOUring, self).setUp()
+        self.assertFalse(self.loop.io_uring)
+        self.loop.io_uring = True
+        if not self.loop.io_uring:
+            self.skipTest('io_uring is not available')
+
+    def tearDown(self):
+        if os.path.exists(TEST_FILE):
+            os.remove(TEST_FILE)
+        super(FSTestIOUring, self).tearDown()
+
+    def test_io_uring_ops(self):
+        self.results = []
+        buf = bytearray(4)
+        def close_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append('close')
+        def readinto_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append(('readinto', req.result, bytes(buf)))
+            pyuv.fs.close(self.loop, self.fd, close_cb)
+        def read_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append(('read', req.result))
+            pyuv.fs.readinto(self.loop, self.fd, buf, 4, readinto_cb)
+        def fstat_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append(('fstat', req.result.st_size))
+            pyuv.fs.read(self.loop, self.fd, 4, 0, read_cb)
+        def fsync_cb(req):
+            self.assertEqual(req.error, None)
+            pyuv.fs.fstat(self.loop, self.fd, fstat_cb)
+        def write_cb(req):
+            self.assertEqual(req.error, None)
+            self.results.append(('write', req.result))
+            pyuv.fs.fdatasync(self.loop, self.fd, lambda req: pyuv.fs.fsync(self.loop, self.fd, fsync_cb))
+        def open_cb(req):
+            self.assertEqual(req.error, None)
+            self.fd = req.result
+            pyuv.fs.writev(self.loop, self.fd, [b"TEST", b"1234"], 0, write_cb)
+        pyuv.fs.open(self.loop, TEST_FILE, os.O_RDWR|os.O_CREAT|os.O_TRUNC, stat.S_IWRITE|stat.S_IREAD, open_cb)
+        self.loop.run()
+        self.assertEqual(self.results, [('write', 8), ('fstat', 8), ('read', b"TEST"), ('readinto', 4, b"1234"), 'close'])
+        st = os.stat(TEST_FILE)
+        self.results = []
+        pyuv.fs.stat(self.loop, TEST_FILE, lambda req: self.results.append(req.result))
+        pyuv.fs.lstat(self.loop, TEST_FILE, lambda req: self.results.append(req.result))
+        pyuv.fs.stat(self.loop, BAD_FILE, lambda req: self.results.append(req.error))
+        self.loop.run()
+        self.assertEqual(self.results[0].st_ino, st.st_ino)
+        self.assertEqual(self.results[0].st_mtime, int(st.st_mtime))
+        self.assertEqual(self.results[1].st_size, 8)
+        self.assertEqual(self.results[2], pyuv.errno.UV_ENOENT)
+
+    def test_io_uring_many(self):
+        self.count = 0
+        fd = pyuv.fs.open(self.loop, TEST_FILE, os.O_RDWR|os.O_CREAT|os.O_TRUNC, stat.S_IWRITE|stat.S_IREAD)
+        def write_cb(req):
+            self.assertEqual(req.error, None)
+            self.count += 1
+        # More operations than fit in the submission ring
+        for i in range(1000):
+            pyuv.fs.write(self.loop, fd, b"x", i, write_cb)
+        self.loop.run()
+        pyuv.fs.close(self.loop, fd)
+        self.assertEqual(self.count, 1000)
+        self.assertEqual(os.path.getsize(TEST_FILE), 1000)
+
+    def test_io_uring_handles(self):
+        # The ring's internal handles are not Python handles
+        self.assertEqual(self.loop.handles, [])
+        timer = pyuv.Timer(self.loop)
+        self.assertEqual(self.loop.handles, [timer])
+        timer.close()
+        self.loop.run()
+
+    def test_io_uring_disable(self):
+        self.errors = []
+        pyuv.fs.stat(self.loop, '.', lambda req: self.errors.append(req.error))
+        self.loop.io_uring = False
+        # the ring is kept until the operation in flight completes, but it's no longer used
+        self.assertFalse(self.loop.io_uring)
+        self.loop.run()
+        self.assertFalse(self.loop.io_uring)
+        pyuv.fs.stat(self.loop, '.', lambda req: self.errors.append(req.error))
+        self.loop.run()
+        self.assertEqual(self.errors, [None, None])
+
+
+class FSTestAsyncFileWriter(TestCase):
+
+    def setUp(self):
+        super(FSTestAsyncFileWriter, self).setUp()
+        self.fd = pyuv.fs.open(self.loop, TEST_FILE, os.O_WRONLY|os.O_CREAT|os.O_TRUNC|os.O_APPEND, stat.S_IWRITE|stat.S_IREAD)
+
+    def tearDown(self):
+        pyuv.fs.close(self.loop, self.fd)
+        os.remove(TEST_FILE)
+        super(FSTestAsyncFileWriter, self).tearDown()
+
+    def test_writer_group_commit(self):
+        self.done = []
+        writer = pyuv.fs.AsyncFileWriter(self.loop, self.fd)
+        def append_cb(w, error):
+            self.assertTrue(w is writer)
+            self.assertEqual(error, None)
+            self.done.append(w.stats.batches)
+        for i in range(100):
+            writer.append(b"%03d\n" % i, append_cb)
+        self.assertTrue(writer.active)
+        self.assertEqual(writer.pending, 100)
+        self.loop.run()
+        self.assertFalse(writer.active)
+        self.assertEqual(writer.pending, 0)
+        self.assertEqual(len(self.done), 100)
+        # the first record goes out on its own, the rest piled up behind it
+        self.assertEqual(self.done, sorted(self.done))
+        stats = writer.stats
+        self.assertEqual(stats.batches, 2)
+        self.assertEqual(stats.records, 100)
+        self.assertEqual(stats.bytes, 400)
+        self.assertEqual(stats.last_batch_records, 99)
+        self.assertEqual(stats.max_batch_records, 99)
+        self.assertTrue(stats.max_latency >= stats.last_latency > 0)
+        self.assertTrue(stats.avg_latency > 0)
+        with open(TEST_FILE, 'rb') as f:
+            self.assertEqual(f.read(), b"".join(b"%03d\n" % i for i in range(100)))
+
+    def test_writer_max_batch_size(self):
+        writer = pyuv.fs.AsyncFileWriter(self.loop, self.fd, datasync=False, max_batch_size=10)
+        data = bytearray(b"x" * 4)
+        for i in range(9):
+            writer.append(data)
+        self.loop.run()
+        self.assertEqual(writer.stats.batches, 5)
+        self.assertEqual(writer.stats.max_batch_records, 2)
+        self.assertEqual(os.path.getsize(TEST_FILE), 36)
+
+    def test_writer_append_from_callback(self):
+        self.count = 0
+        writer = pyuv.fs.AsyncFileWriter(self.loop, self.fd)
+        def append_cb(w, error):
+            self.assertEqual(error, None)
+            self.count += 1
+            if self.count < 5:
+                w.append(b"TEST", append_cb)
+        writer.append(b"TEST", append_cb)
+        self.loop.run()
+        self.assertEqual(self.count, 5)
+        self.assertEqual(writer.stats.batches, 5)
+        self.assertEqual(os.path.getsize(TEST_FILE), 20)
+
+    def test_writer_error(self):
+        self.errors = []
+        rfd = pyuv.fs.open(self.loop, TEST_FILE, os.O_RDONLY, 0)
+        writer = pyuv.fs.AsyncFileWriter(self.loop, rfd)
+        writer.append(b"TEST", lambda w, error: self.errors.append(error))
+        writer.append(b"TEST", lambda w, error: self.errors.append(error))
+        self.loop.run()
+        pyuv.fs.close(self.loop, rfd)
+        self.assertEqual(self.errors, [pyuv.errno.UV_EBADF, pyuv.errno.UV_EBADF])
+        self.assertEqual(writer.stats.bytes, 0)
+        self.assertRaises(TypeError, writer.append, u"TEST")
+        self.assertRaises(TypeError, writer.append, b"TEST", 42)
+        self.assertRaises(ValueError, pyuv.fs.AsyncFileWriter, self.loop, self.fd, max_batch_size=0)
+
+
+@unittest.skipIf(os.name == 'nt', 'mmap is not supported on Windows')
+class FSTestMMap(TestCase):
+
+    def setUp(self):
+        super(FSTestMMap, self).setUp()
+        self.data = b"".join(b"%07d\n" % i for i in range(4096))
+        with open(TEST_FILE, 'wb') as f:
+            f.write(self.data)
+        self.fd = pyuv.fs.open(self.loop, TEST_FILE, os.O_RDONLY, 0)
+
+    def tearDown(self):
+        pyuv.fs.close(self.loop, self.fd)
+        os.remove(TEST_FILE)
+        super(FSTestMMap, self).tearDown()
+
+    def test_mmap(self):
+        m = pyuv.fs.mmap(self.loop, self.fd, 0)
+        self.assertEqual(len(m), len(self.data))
+        self.assertEqual(bytes(memoryview(m)), self.data)
+        # offsets don't need to be page aligned
+        m2 = pyuv.fs.mmap(self.loop, self.fd, 16, 8 * 1000)
+        self.assertEqual(bytes(memoryview(m2)), b"0001000\n0001001\n")
+        self.assertRaises(TypeError, memoryview(m2).__setitem__, 0, 1)
+        m2.close()
+        self.assertTrue(m2.closed)
+        self.assertRaises(ValueError, memoryview, m2)
+        self.assertRaises(ValueError, pyuv.fs.mmap, self.loop, self.fd, len(self.data) + 1)
+        self.assertRaises(ValueError, pyuv.fs.mmap, self.loop, self.fd, 0, len(self.data) + 1)
+        self.assertRaises(pyuv.error.FSError, pyuv.fs.mmap, self.loop, -1, 0)
+        m.close()
+
+    def test_mmap_advise(self):
+        self.errors = []
+        m = pyuv.fs.mmap(self.loop, self.fd, 0)
+        def advise_cb(mm, error):
+            self.assertTrue(mm is m)
+            self.errors.append(error)
+        m.advise(pyuv.fs.MADV_SEQUENTIAL, callback=advise_cb)
+        m.advise(pyuv.fs.MADV_WILLNEED, 5000, 100, advise_cb)
+        # the threadpool is using the mapping
+        self.assertRaises(BufferError, m.close)
+        self.loop.run()
+        self.assertEqual(self.errors, [None, None])
+        m.advise(pyuv.fs.MADV_RANDOM)
+        self.assertRaises(pyuv.error.FSError, m.advise, 12345)
+        self.assertEqual(bytes(memoryview(m)[5000:5008]), self.data[5000:5008])
+        m.close()
+        self.assertRaises(ValueError, m.advise, pyuv.fs.MADV_NORMAL)
+
+    def test_mmap_exported(self):
+        m = pyuv.fs.mmap(self.loop, self.fd, 8)
+        view = memoryview(m)
+        self.assertRaises(BufferError, m.close)
+        self.assertFalse(m.closed)
+        self.assertEqual(view.tobytes(), b"0000000\n")
+        view.release()
+        m.close()
+        self.assertTrue(m.closed)
+
+
 class FSTestFsync(TestCase):
 
     def write_cb(self, req):
@@ -703,6 +1174,40 @@ class FSTestScandir(TestCase):
             self.errorno = None
         self.assertEqual(self.errorno, pyuv.errno.UV_ENOENT)
 
+    def scandir_chunked(self, path, chunk_size):
+        self.chunks = []
+        self.errorno = None
+        def scandir_cb(req):
+            self.errorno = req.error
+            self.chunks.append(req.result)
+        pyuv.fs.scandir(self.loop, path, scandir_cb, chunk_size=chunk_size)
+        self.loop.run()
+
+    def test_scandir_chunked(self):
+        for i in range(97):
+            open(os.path.join(TEST_DIR, 'file%d' % i), 'w').close()
+        self.scandir_chunked(TEST_DIR, 10)
+        self.assertEqual(self.errorno, None)
+        self.assertEqual([len(c) for c in self.chunks], [10] * 10 + [0])
+        names = set(f.name for c in self.chunks for f in c)
+        self.assertEqual(len(names), 100)
+        self.assertTrue(TEST_DIR2 in names)
+        types = dict((f.name, f.type) for c in self.chunks for f in c)
+        self.assertEqual(types[TEST_FILE], pyuv.fs.UV_DIRENT_FILE)
+        self.assertEqual(types[TEST_DIR2], pyuv.fs.UV_DIRENT_DIR)
+
+    def test_scandir_chunked_exact(self):
+        self.scandir_chunked(TEST_DIR, 3)
+        self.assertEqual([len(c) for c in self.chunks], [3, 0])
+
+    def test_scandir_chunked_error(self):
+        self.scandir_chunked(BAD_DIR, 10)
+        self.assertEqual(self.chunks, [None])
+        self.assertEqual(self.errorno, pyuv.errno.UV_ENOENT)
+        self.assertRaises(ValueError, pyuv.fs.scandir, self.loop, TEST_DIR, chunk_size=10)
+        self.assertRaises(ValueError, pyuv.fs.scandir, self.loop, TEST_DIR, self.scandir_cb, chunk_size=-1)
+        self.assertRaises(ValueError, pyuv.fs.scandir, self.loop, TEST_DIR, self.scandir_cb, chunk_size=sys.maxsize)
+
 
 class FSTestSendfile(TestCase):
 
@@ -763,6 +1268,81 @@ class FSTestSendfile(TestCase):
             with open(TEST_FILE2, 'r') as fobj2:
                 self.assertEqual(fobj1.read(), fobj2.read())
 
+    def test_sendfile_progress(self):
+        self.progress = []
+        fd = pyuv.fs.open(self.loop, TEST_FILE, os.O_RDWR, stat.S_IREAD|stat.S_IWRITE)
+        fd2 = pyuv.fs.open(self.loop, TEST_FILE2, os.O_RDWR|os.O_CREAT, stat.S_IREAD|stat.S_IWRITE)
+        # lengths past 2GB are accepted, the transfer stops at the end of the file
+        length = 2**33
+        pyuv.fs.sendfile(self.loop, fd2, fd, 0, length, self.sendfile_cb, progress=lambda sent, total: self.progress.append((sent, total)))
+        self.loop.run()
+        pyuv.fs.close(self.loop, fd)
+        pyuv.fs.close(self.loop, fd2)
+        size = os.path.getsize(TEST_FILE)
+        self.assertEqual(self.errorno, None)
+        self.assertEqual(self.bytes_written, size)
+        self.assertEqual(self.progress, [(size, length)])
+        with open(TEST_FILE, 'r') as fobj1:
+            with open(TEST_FILE2, 'r') as fobj2:
+                self.assertEqual(fobj1.read(), fobj2.read())
+        self.assertRaises(ValueError, pyuv.fs.sendfile, self.loop, fd2, fd, 0, 4, progress=lambda sent, total: None)
+        self.assertRaises(ValueError, pyuv.fs.sendfile, self.loop, fd2, fd, 0, -1)
+
+
+class FSTestCopyfile(TestCase):
+
+    def setUp(self):
+        super(FSTestCopyfile, self).setUp()
+        self.data = os.urandom(200000)
+        with open(TEST_FILE, 'wb') as f:
+            f.write(self.data)
+        os.chmod(TEST_FILE, stat.S_IREAD|stat.S_IWRITE|stat.S_IRGRP)
+
+    def tearDown(self):
+        for path in (TEST_FILE, TEST_FILE2):
+            if os.path.exists(path):
+                os.remove(path)
+        super(FSTestCopyfile, self).tearDown()
+
+    def copyfile_cb(self, req):
+        self.result = req.result
+        self.errorno = req.error
+
+    def test_copyfile(self):
+        pyuv.fs.copyfile(self.loop, TEST_FILE, TEST_FILE2, callback=self.copyfile_cb)
+        self.loop.run()
+        self.assertEqual(self.errorno, None)
+        self.assertEqual(self.result, len(self.data))
+        with open(TEST_FILE2, 'rb') as f:
+            self.assertEqual(f.read(), self.data)
+        self.assertEqual(stat.S_IMODE(os.stat(TEST_FILE2).st_mode), stat.S_IMODE(os.stat(TEST_FILE).st_mode))
+
+    def test_copyfile_sync(self):
+        with open(TEST_FILE2, 'wb') as f:
+            f.write(b"x" * 300000)
+        self.assertEqual(pyuv.fs.copyfile(self.loop, TEST_FILE, TEST_FILE2), len(self.data))
+        with open(TEST_FILE2, 'rb') as f:
+            self.assertEqual(f.read(), self.data)
+
+    def test_copyfile_same_file(self):
+        self.assertEqual(pyuv.fs.copyfile(self.loop, TEST_FILE, TEST_FILE), 0)
+        with open(TEST_FILE, 'rb') as f:
+            self.assertEqual(f.read(), self.data)
+
+    def test_copyfile_error(self):
+        pyuv.fs.copyfile(self.loop, BAD_FILE, TEST_FILE2, callback=self.copyfile_cb)
+        self.loop.run()
+        self.assertEqual(self.errorno, pyuv.errno.UV_ENOENT)
+        self.assertFalse(os.path.exists(TEST_FILE2))
+        with open(TEST_FILE2, 'wb') as f:
+            f.write(b"TEST")
+        pyuv.fs.copyfile(self.loop, TEST_FILE, TEST_FILE2, pyuv.fs.UV_FS_COPYFILE_EXCL, self.copyfile_cb)
+        self.loop.run()
+        self.assertEqual(self.errorno, pyuv.errno.UV_EEXIST)
+        with open(TEST_FILE2, 'rb') as f:
+            self.assertEqual(f.read(), b"TEST")
+        self.assertRaises(ValueError, pyuv.fs.copyfile, self.loop, TEST_FILE, TEST_FILE2, 0x100)
+
 
 class FSTestUtime(FileTestCase):
 
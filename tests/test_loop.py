@@ -1,4 +1,6 @@
 
+import os
+import threading
 import unittest
 
 from common import TestCase
@@ -56,6 +58,123 @@ class LoopRunTest(TestCase):
         self.assertEqual(self.prepare_called, 10)
 
 
+class LoopHoldGILTest(TestCase):
+
+    def test_hold_gil(self):
+        self.assertFalse(self.loop.hold_gil)
+        self.loop.hold_gil = True
+        self.assertTrue(self.loop.hold_gil)
+        self.prepare_called = 0
+        self.timer_called = 0
+        self.async_called = 0
+        def prepare_cb(handle):
+            self.prepare_called += 1
+        def async_cb(handle):
+            self.async_called += 1
+            handle.close()
+        def timer_cb(handle):
+            self.timer_called += 1
+            if self.timer_called == 5:
+                handle.close()
+                prepare.close()
+        def thread_cb():
+            # Only gets to run if the loop releases the GIL while polling
+            async_h.send()
+        prepare = pyuv.Prepare(self.loop)
+        prepare.start(prepare_cb)
+        timer = pyuv.Timer(self.loop)
+        timer.start(timer_cb, 0.01, 0.01)
+        async_h = pyuv.Async(self.loop, async_cb)
+        t = threading.Thread(target=thread_cb)
+        t.start()
+        self.loop.run()
+        t.join()
+        self.assertEqual(self.timer_called, 5)
+        self.assertEqual(self.async_called, 1)
+        self.assertTrue(self.prepare_called >= 5)
+
+    def test_hold_gil_set_while_running(self):
+        self.loop.hold_gil = True
+        def timer_cb(handle):
+            self.assertRaises(RuntimeError, setattr, self.loop, 'hold_gil', False)
+            handle.close()
+        timer = pyuv.Timer(self.loop)
+        timer.start(timer_cb, 0, 0)
+        self.loop.run()
+        self.loop.hold_gil = False
+        self.assertFalse(self.loop.hold_gil)
+
+
+class LoopBufferPoolTest(TestCase):
+
+    def test_buffer_pool(self):
+        self.assertEqual(self.loop.buffer_size, 65536)
+        self.loop.buffer_size = 256 * 1024
+        self.loop.buffer_pool_size = 2
+        self.assertEqual(self.loop.buffer_size, 256 * 1024)
+        self.assertEqual(self.loop.buffer_pool_size, 2)
+        self.assertRaises(ValueError, setattr, self.loop, 'buffer_size', 0)
+        self.assertRaises(ValueError, setattr, self.loop, 'buffer_pool_size', -1)
+        self.data = []
+        def read_cb(handle, data, error):
+            if data is None:
+                handle.close()
+                return
+            self.data.append(data)
+        r, w = os.pipe()
+        pipe = pyuv.Pipe(self.loop)
+        pipe.open(r)
+        pipe.start_read(read_cb)
+        os.write(w, b"PING")
+        self.loop.run(pyuv.UV_RUN_ONCE)
+        os.write(w, b"PONG")
+        os.close(w)
+        self.loop.run()
+        self.assertEqual(b"".join(self.data), b"PINGPONG")
+        stats = self.loop.buffer_stats
+        self.assertEqual(stats.in_use, 0)
+        self.assertEqual(stats.free, 1)
+        self.assertEqual(stats.memory, 256 * 1024)
+        self.assertEqual(stats.misses, 1)
+        self.assertTrue(stats.hits >= 1)
+        self.loop.buffer_pool_size = 0
+        stats = self.loop.buffer_stats
+        self.assertEqual(stats.free, 0)
+        self.assertEqual(stats.memory, 0)
+
+
+class LoopRequestCacheTest(TestCase):
+
+    def test_request_cache(self):
+        self.assertEqual(self.loop.request_cache_size, 64)
+        self.assertRaises(ValueError, setattr, self.loop, 'request_cache_size', -1)
+        self.writes = 0
+        def write_cb(handle, error):
+            self.assertEqual(error, None)
+            self.writes += 1
+            if self.writes == 2:
+                handle.close()
+                return
+            handle.write(b"PONG", write_cb)
+        r, w = os.pipe()
+        pipe = pyuv.Pipe(self.loop)
+        pipe.open(w)
+        pipe.write(b"PING", write_cb)
+        stats = self.loop.request_cache_stats
+        self.assertEqual(stats.in_use, 1)
+        self.assertEqual(stats.misses, 1)
+        self.loop.run()
+        os.close(r)
+        self.assertEqual(self.writes, 2)
+        stats = self.loop.request_cache_stats
+        self.assertEqual(stats.in_use, 0)
+        self.assertEqual(stats.free, 2)
+        self.assertEqual(stats.misses, 2)
+        self.loop.request_cache_size = 0
+        stats = self.loop.request_cache_stats
+        self.assertEqual(stats.free, 0)
+
+
 class LoopAliveTest(TestCase):
 
     def test_loop_alive(self):
@@ -1,4 +1,6 @@
 
+import os
+import struct
 import sys
 import unittest
 
@@ -282,6 +284,156 @@ class PipeTestFileno(TestCase):
         self.loop.run()
 
 
+@platform_skip(["win32"])
+class PipeTestFraming(TestCase):
+
+    def setUp(self):
+        super(PipeTestFraming, self).setUp()
+        self.frames = []
+        self.errors = []
+        self.r, self.w = os.pipe()
+        self.pipe = pyuv.Pipe(self.loop)
+        self.pipe.open(self.r)
+
+    def on_read(self, handle, data, error):
+        if error is not None:
+            self.errors.append(error)
+            handle.close()
+            return
+        self.frames.append(data)
+
+    def feed(self, *chunks):
+        for chunk in chunks:
+            os.write(self.w, chunk)
+            self.loop.run(pyuv.UV_RUN_ONCE)
+        os.close(self.w)
+        self.loop.run()
+
+    def test_framing_delimiter(self):
+        self.pipe.start_read(self.on_read, delimiter=b"\r\n")
+        self.feed(b"foo\r", b"\nbar\r\nba", b"z\r\n\r\nqu", b"x")
+        self.assertEqual(self.frames, [b"foo", b"bar", b"baz", b""])
+        self.assertEqual(self.errors, [pyuv.errno.UV_EOF])
+
+    def test_framing_length_prefix(self):
+        self.pipe.start_read(self.on_read, length_prefix=2, batch=True)
+        data = b"".join(struct.pack(">H", len(f)) + f for f in (b"PING", b"", b"PONG", b"x" * 300))
+        self.feed(data[:3], data[3:9], data[9:])
+        self.assertEqual(self.frames, [[b"PING", b""], [b"PONG", b"x" * 300]])
+        self.assertEqual(self.errors, [pyuv.errno.UV_EOF])
+
+    def test_framing_max_frame_size(self):
+        self.pipe.start_read(self.on_read, length_prefix=4, byteorder="little", max_frame_size=4)
+        self.feed(struct.pack("<I", 4) + b"PING" + struct.pack("<I", 5) + b"PONGS")
+        self.assertEqual(self.frames, [b"PING"])
+        self.assertEqual(self.errors, [pyuv.errno.UV_EMSGSIZE])
+
+    def test_framing_invalid_args(self):
+        self.assertRaises(ValueError, self.pipe.start_read, self.on_read, delimiter=b"\n", length_prefix=4)
+        self.assertRaises(ValueError, self.pipe.start_read, self.on_read, length_prefix=3)
+        self.assertRaises(ValueError, self.pipe.start_read, self.on_read, length_prefix=4, byteorder="middle")
+        self.assertRaises(ValueError, self.pipe.start_read, self.on_read, batch=True)
+        self.assertRaises(ValueError, self.pipe.start_read, self.on_read, delimiter=b"\n", zero_copy=True)
+        self.assertRaises(TypeError, self.pipe.start_read, self.on_read, delimiter=b"")
+        self.pipe.close()
+        os.close(self.w)
+        self.loop.run()
+
+
+@platform_skip(["win32"])
+class PipeTestPipeTo(TestCase):
+
+    def test_pipe_to(self):
+        data = b"x" * (1024 * 1024) + b"END"
+        self.received = []
+        self.end_called = False
+        r1, w1 = os.pipe()
+        r2, w2 = os.pipe()
+        writer = pyuv.Pipe(self.loop)
+        writer.open(w1)
+        source = pyuv.Pipe(self.loop)
+        source.open(r1)
+        dest = pyuv.Pipe(self.loop)
+        dest.open(w2)
+        reader = pyuv.Pipe(self.loop)
+        reader.open(r2)
+        def on_write(handle, error):
+            self.assertEqual(error, None)
+            handle.close()
+        def on_end(handle, error):
+            self.assertEqual(error, None)
+            self.assertIs(handle, source)
+            self.end_called = True
+            stats = source.pipe_stats
+            self.assertEqual(stats.bytes_read, len(data))
+            self.assertEqual(stats.bytes_written, len(data))
+            self.assertEqual(stats.pending, 0)
+            self.assertFalse(stats.paused)
+            source.close()
+            dest.close()
+        def on_read(handle, chunk, error):
+            if chunk is None:
+                handle.close()
+                return
+            self.received.append(chunk)
+        self.assertRaises(ValueError, source.pipe_to, source)
+        self.assertRaises(TypeError, source.pipe_to, pyuv.Timer(self.loop))
+        writer.write(data, on_write)
+        source.pipe_to(dest, on_end, high_watermark=1024)
+        reader.start_read(on_read)
+        self.loop.run()
+        self.assertTrue(self.end_called)
+        self.assertEqual(b"".join(self.received), data)
+
+    def test_pipe_to_foreign_writes(self):
+        data = b"x" * (1024 * 1024)
+        extra = b"y" * (256 * 1024)
+        self.received = []
+        self.end_called = False
+        r1, w1 = os.pipe()
+        r2, w2 = os.pipe()
+        writer = pyuv.Pipe(self.loop)
+        writer.open(w1)
+        source = pyuv.Pipe(self.loop)
+        source.open(r1)
+        dest = pyuv.Pipe(self.loop)
+        dest.open(w2)
+        reader = pyuv.Pipe(self.loop)
+        reader.open(r2)
+        timer = pyuv.Timer(self.loop)
+        def on_write(handle, error):
+            self.assertEqual(error, None)
+            handle.close()
+        def on_extra_write(handle, error):
+            self.assertEqual(error, None)
+        def on_timer(handle):
+            # Nobody reads from dest yet, so the pipe is paused. Queue our own data on dest so the
+            # queue is still above the low mark when the last write issued by the pipe completes
+            self.assertTrue(source.pipe_stats.paused)
+            dest.write(extra, on_extra_write)
+            reader.start_read(on_read)
+            handle.close()
+        def on_end(handle, error):
+            self.assertEqual(error, None)
+            self.end_called = True
+            self.assertEqual(source.pipe_stats.bytes_written, len(data))
+            source.close()
+            dest.close()
+        def on_read(handle, chunk, error):
+            if chunk is None:
+                handle.close()
+                return
+            self.received.append(chunk)
+        writer.write(data, on_write)
+        source.pipe_to(dest, on_end, high_watermark=1024)
+        timer.start(on_timer, 0.1, 0)
+        self.loop.run()
+        self.assertTrue(self.end_called)
+        received = b"".join(self.received)
+        self.assertEqual(received.count(b"x"), len(data))
+        self.assertEqual(received.count(b"y"), len(extra))
+
+
 @platform_skip(["win32"])
 class PipeBytesBind(TestCase):
 
@@ -91,6 +91,14 @@ class TCPTest(TestCase):
         self.server.close()
         self.loop.run()
 
+    def test_tcp_address(self):
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(pyuv.Address("0.0.0.0", TEST_PORT))
+        self.server.listen(self.on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(pyuv.Address("127.0.0.1", TEST_PORT), self.on_client_connection)
+        self.loop.run()
+
 
 class TCPTest2(TestCase):
 
@@ -205,6 +213,330 @@ class TCPTestMemoryview(TestCase):
         self.loop.run()
 
 
+class TCPTestZeroCopyRead(TestCase):
+
+    def setUp(self):
+        super(TCPTestZeroCopyRead, self).setUp()
+        self.server = None
+        self.client = None
+        self.client_connections = []
+        self.kept = None
+        self.received = []
+
+    def on_connection(self, server, error):
+        self.assertEqual(error, None)
+        client = pyuv.TCP(self.loop)
+        server.accept(client)
+        self.client_connections.append(client)
+        client.start_read(self.on_client_connection_read)
+        client.write(b"PING", self.on_server_write)
+
+    def on_server_write(self, client, error):
+        self.assertEqual(error, None)
+        client.write(b"PONG")
+        client.close()
+        self.client_connections.remove(client)
+        self.server.close()
+
+    def on_client_connection_read(self, client, data, error):
+        pass
+
+    def on_client_connection(self, client, error):
+        self.assertEqual(error, None)
+        client.start_read(self.on_client_read, zero_copy=True)
+
+    def on_client_read(self, client, data, error):
+        if data is None:
+            client.close()
+            return
+        self.assertIsInstance(data, memoryview)
+        self.assertTrue(data.readonly)
+        if self.kept is None:
+            # keep the first view around past the callback
+            self.kept = data
+        else:
+            self.received.append(bytes(data))
+            data.release()
+
+    def test_tcp_zero_copy_read(self):
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(("0.0.0.0", TEST_PORT))
+        self.server.listen(self.on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(("127.0.0.1", TEST_PORT), self.on_client_connection)
+        self.loop.run()
+        self.assertEqual(bytes(self.kept) + b"".join(self.received), b"PINGPONG")
+        self.kept.release()
+        self.assertEqual(self.loop.buffer_stats.in_use, 0)
+
+
+class TCPTestReadInto(TestCase):
+
+    def setUp(self):
+        super(TCPTestReadInto, self).setUp()
+        self.server = None
+        self.client = None
+        self.client_connections = []
+        self.buf = bytearray(2)
+        self.received = bytearray()
+
+    def on_connection(self, server, error):
+        self.assertEqual(error, None)
+        client = pyuv.TCP(self.loop)
+        server.accept(client)
+        self.client_connections.append(client)
+        client.start_read(self.on_client_connection_read)
+        client.write(b"PINGPONG")
+        client.close()
+        self.client_connections.remove(client)
+        self.server.close()
+
+    def on_client_connection_read(self, client, data, error):
+        pass
+
+    def on_client_connection(self, client, error):
+        self.assertEqual(error, None)
+        client.start_read_into(self.buf, self.on_client_read)
+
+    def on_client_read(self, client, nread, error):
+        if error is not None:
+            self.assertEqual(nread, None)
+            client.close()
+            return
+        self.assertTrue(0 < nread <= len(self.buf))
+        self.received += self.buf[:nread]
+
+    def test_tcp_read_into(self):
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(("0.0.0.0", TEST_PORT))
+        self.server.listen(self.on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(("127.0.0.1", TEST_PORT), self.on_client_connection)
+        self.loop.run()
+        self.assertEqual(bytes(self.received), b"PINGPONG")
+
+    def test_tcp_read_into_callable(self):
+        buffers = []
+        def provider(handle):
+            self.assertIs(handle, self.client)
+            buffers.append(bytearray(3))
+            self.buf = buffers[-1]
+            return memoryview(self.buf)
+        def on_client_connection(client, error):
+            self.assertEqual(error, None)
+            client.start_read_into(provider, self.on_client_read)
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(("0.0.0.0", TEST_PORT))
+        self.server.listen(self.on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(("127.0.0.1", TEST_PORT), on_client_connection)
+        self.loop.run()
+        self.assertEqual(bytes(self.received), b"PINGPONG")
+        self.assertTrue(len(buffers) >= 3)
+
+    def test_tcp_read_into_invalid(self):
+        client = pyuv.TCP(self.loop)
+        self.assertRaises(TypeError, client.start_read_into, 42, lambda *args: None)
+        self.assertRaises(TypeError, client.start_read_into, b"read-only", lambda *args: None)
+        client.close()
+        self.loop.run()
+
+
+class TCPTestEagerWrite(TestCase):
+
+    def setUp(self):
+        super(TCPTestEagerWrite, self).setUp()
+        self.server = None
+        self.client = None
+        self.written = False
+        self.write_cb_count = 0
+        self.received = []
+        self.payload = b"x" * (4 * 1024 * 1024)
+
+    def on_connection(self, server, error):
+        self.assertEqual(error, None)
+        client = pyuv.TCP(self.loop)
+        server.accept(client)
+        self.assertFalse(client.eager_write)
+        client.eager_write = True
+        self.assertTrue(client.eager_write)
+        client.write([b"PING", b"PONG"], self.on_write)
+        self.assertEqual(self.write_cb_count, 0)
+        client.write(self.payload, self.on_write)
+        client.write(b"END")
+        client.shutdown(self.on_shutdown)
+        self.server.close()
+
+    def on_write(self, handle, error):
+        self.assertEqual(error, None)
+        self.write_cb_count += 1
+
+    def on_shutdown(self, handle, error):
+        self.assertEqual(self.write_cb_count, 2)
+        handle.close()
+
+    def on_client_connection(self, client, error):
+        self.assertEqual(error, None)
+        client.start_read(self.on_client_read)
+
+    def on_client_read(self, client, data, error):
+        if data is None:
+            client.close()
+            return
+        self.received.append(data)
+
+    def test_tcp_eager_write(self):
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(("0.0.0.0", TEST_PORT))
+        self.server.listen(self.on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(("127.0.0.1", TEST_PORT), self.on_client_connection)
+        self.loop.run()
+        self.assertEqual(self.write_cb_count, 2)
+        self.assertEqual(b"".join(self.received), b"PINGPONG" + self.payload + b"END")
+
+    def test_tcp_eager_write_close(self):
+        def on_close(handle):
+            self.assertEqual(self.write_cb_count, 1)
+        def on_connection(server, error):
+            self.assertEqual(error, None)
+            client = pyuv.TCP(self.loop)
+            server.accept(client)
+            client.eager_write = True
+            client.write(b"PING", self.on_write)
+            client.close(on_close)
+            server.close()
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(("0.0.0.0", TEST_PORT))
+        self.server.listen(on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(("127.0.0.1", TEST_PORT), self.on_client_connection)
+        self.loop.run()
+        self.assertEqual(self.write_cb_count, 1)
+        self.assertEqual(b"".join(self.received), b"PING")
+
+
+class TCPTestCoalesceWrites(TestCase):
+
+    def setUp(self):
+        super(TCPTestCoalesceWrites, self).setUp()
+        self.server = None
+        self.client = None
+        self.write_cb_order = []
+        self.received = []
+
+    def on_write(self, n):
+        def cb(handle, error):
+            self.assertEqual(error, None)
+            self.write_cb_order.append(n)
+        return cb
+
+    def on_client_connection(self, client, error):
+        self.assertEqual(error, None)
+        client.start_read(self.on_client_read)
+
+    def on_client_read(self, client, data, error):
+        if data is None:
+            client.close()
+            return
+        self.received.append(data)
+
+    def run_server(self, on_connection):
+        self.server = pyuv.TCP(self.loop)
+        self.server.bind(("0.0.0.0", TEST_PORT))
+        self.server.listen(on_connection)
+        self.client = pyuv.TCP(self.loop)
+        self.client.connect(("127.0.0.1", TEST_PORT), self.on_client_connection)
+        self.loop.run()
+
+    def test_tcp_cork(self):
+        def on_connection(server, error):
+            self.assertEqual(error, None)
+            client = pyuv.TCP(self.loop)
+            server.accept(client)
+            client.cork()
+            client.write(b"PING", self.on_write(1))
+            client.write([b"PO", b"NG"], self.on_write(2))
+            client.write(b"!")
+            self.assertEqual(client.write_queue_size, 9)
+            self.assertRaises(pyuv.error.TCPError, client.try_write, b"X")
+            timer = pyuv.Timer(self.loop)
+            def timer_cb(timer):
+                timer.close()
+                self.assertEqual(self.write_cb_order, [])
+                client.uncork()
+                client.close()
+            timer.start(timer_cb, 0.05, 0)
+            server.close()
+        self.run_server(on_connection)
+        self.assertEqual(self.write_cb_order, [1, 2])
+        self.assertEqual(b"".join(self.received), b"PINGPONG!")
+
+    def test_tcp_coalesce_writes(self):
+        def on_shutdown(handle, error):
+            self.assertEqual(self.write_cb_order, [1, 2, 3])
+            handle.close()
+        def on_connection(server, error):
+            self.assertEqual(error, None)
+            client = pyuv.TCP(self.loop)
+            server.accept(client)
+            self.assertFalse(client.coalesce_writes)
+            client.coalesce_writes = True
+            client.write(b"PING", self.on_write(1))
+            client.write(b"PONG", self.on_write(2))
+            client.write(b"x" * (1024 * 1024), self.on_write(3))
+            timer = pyuv.Timer(self.loop)
+            def timer_cb(timer):
+                timer.close()
+                client.shutdown(on_shutdown)
+            timer.start(timer_cb, 0.05, 0)
+            server.close()
+        self.run_server(on_connection)
+        self.assertEqual(b"".join(self.received), b"PINGPONG" + b"x" * (1024 * 1024))
+
+
+class TCPTestWatermarks(TestCase):
+
+    def test_tcp_write_watermarks(self):
+        self.events = []
+        self.received = []
+        def on_pause(handle):
+            self.events.append("pause")
+        def on_resume(handle):
+            self.events.append("resume")
+            handle.close()
+        def on_connection(server, error):
+            self.assertEqual(error, None)
+            client = pyuv.TCP(self.loop)
+            server.accept(client)
+            self.assertRaises(ValueError, client.set_write_watermarks, 10, 20)
+            client.set_write_watermarks(8, 2, on_pause, on_resume)
+            client.cork()
+            client.write(b"PING")
+            client.write(b"PONG")
+            self.assertEqual(self.events, [])
+            client.write(b"!")
+            self.assertEqual(self.events, ["pause"])
+            client.uncork()
+            server.close()
+        def on_client_read(client, data, error):
+            if data is None:
+                client.close()
+                return
+            self.received.append(data)
+        def on_client_connection(client, error):
+            self.assertEqual(error, None)
+            client.start_read(on_client_read)
+        server = pyuv.TCP(self.loop)
+        server.bind(("0.0.0.0", TEST_PORT))
+        server.listen(on_connection)
+        client = pyuv.TCP(self.loop)
+        client.connect(("127.0.0.1", TEST_PORT), on_client_connection)
+        self.loop.run()
+        self.assertEqual(self.events, ["pause", "resume"])
+        self.assertEqual(b"".join(self.received), b"PINGPONG!")
+
+
 class TCPTestNull(TestCase):
 
     def setUp(self):
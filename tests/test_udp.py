@@ -1,4 +1,5 @@
 
+import pickle
 import socket
 import sys
 import unittest
@@ -448,6 +449,320 @@ class UDPTryTest(TestCase):
         self.assertEqual(self.on_close_called, 3)
 
 
+class UDPTestWatermarks(TestCase):
+
+    def test_udp_send_watermarks(self):
+        self.events = []
+        def on_pause(handle):
+            self.events.append("pause")
+        def on_resume(handle):
+            self.events.append("resume")
+            handle.close()
+        def on_send(handle, error):
+            self.assertEqual(error, None)
+            self.events.append("send")
+        client = pyuv.UDP(self.loop)
+        self.assertRaises(ValueError, client.set_send_watermarks, 10, 20)
+        self.assertRaises(TypeError, client.set_send_watermarks, 10, 5, 42)
+        client.set_send_watermarks(4, 0, on_pause, on_resume)
+        client.send(("127.0.0.1", TEST_PORT), b"PING", on_send)
+        self.assertEqual(self.events, [])
+        client.send(("127.0.0.1", TEST_PORT), b"PONG", on_send)
+        self.assertEqual(self.events, ["pause"])
+        self.loop.run()
+        self.assertEqual(self.events, ["pause", "send", "send", "resume"])
+
+
+class UDPTestBatchRecv(TestCase):
+
+    def on_server_recv(self, handle, datagrams, error):
+        self.assertEqual(error, None)
+        self.assertTrue(0 < len(datagrams) <= 32)
+        self.batches.append(datagrams)
+        if sum(len(batch) for batch in self.batches) == 100:
+            handle.close()
+
+    def test_udp_batch_recv(self):
+        self.batches = []
+        server = pyuv.UDP(self.loop)
+        server.bind(("127.0.0.1", TEST_PORT))
+        server.start_recv(self.on_server_recv, max_batch=32)
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.bind(("127.0.0.1", TEST_PORT2))
+        for i in range(100):
+            sock.sendto(b"PING%d" % i, ("127.0.0.1", TEST_PORT))
+        self.loop.run()
+        sock.close()
+        datagrams = [d for batch in self.batches for d in batch]
+        self.assertEqual([data for addr, data in datagrams], [b"PING%d" % i for i in range(100)])
+        self.assertEqual(datagrams[0][0], ("127.0.0.1", TEST_PORT2))
+        # datagrams from the same peer share the address object
+        if len(self.batches[0]) > 1:
+            self.assertTrue(self.batches[0][0][0] is self.batches[0][1][0])
+        if sys.platform.startswith('linux'):
+            # the queue is drained with recvmmsg, so batches are full
+            self.assertEqual([len(batch) for batch in self.batches], [32, 32, 32, 4])
+
+    def test_udp_batch_recv_stop(self):
+        self.batches = []
+        def on_recv(handle, datagrams, error):
+            self.batches.append(len(datagrams))
+            handle.stop_recv()
+            handle.close()
+        server = pyuv.UDP(self.loop)
+        server.bind(("127.0.0.1", TEST_PORT))
+        self.assertRaises(ValueError, server.start_recv, on_recv, max_batch=-1)
+        server.start_recv(on_recv, max_batch=4)
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        for i in range(10):
+            sock.sendto(b"PING", ("127.0.0.1", TEST_PORT))
+        self.loop.run()
+        sock.close()
+        self.assertEqual(len(self.batches), 1)
+        self.assertTrue(0 < self.batches[0] <= 4)
+
+
+class UDPTestSendMany(TestCase):
+
+    def setUp(self):
+        super(UDPTestSendMany, self).setUp()
+        self.received = []
+        self.server = pyuv.UDP(self.loop)
+        self.server.bind(("127.0.0.1", TEST_PORT))
+        self.server.start_recv(self.on_server_recv)
+
+    def on_server_recv(self, handle, ip_port, flags, data, error):
+        self.assertEqual(error, None)
+        self.received.append(data)
+        if len(self.received) == self.expected:
+            handle.close()
+
+    def test_udp_send_many(self):
+        self.errors = None
+        self.expected = 100
+        def on_send(handle, errors):
+            self.errors = errors
+            handle.close()
+        client = pyuv.UDP(self.loop)
+        client.bind(("127.0.0.1", TEST_PORT2))
+        client.send_many([(("127.0.0.1", TEST_PORT), b"PING%d" % i) for i in range(100)], on_send)
+        self.loop.run()
+        self.assertEqual(self.errors, [None] * 100)
+        self.assertEqual(self.received, [b"PING%d" % i for i in range(100)])
+
+    def test_udp_send_to_all(self):
+        self.errors = None
+        self.expected = 3
+        def on_send(handle, errors):
+            self.errors = errors
+            handle.close()
+        client = pyuv.UDP(self.loop)
+        client.bind(("127.0.0.1", TEST_PORT2))
+        # the IPv6 destination fails on its own, the rest go through
+        client.send_to_all([("127.0.0.1", TEST_PORT), ("::1", TEST_PORT), ("127.0.0.1", TEST_PORT), ("127.0.0.1", TEST_PORT)], b"PING", on_send)
+        self.loop.run()
+        self.assertEqual(self.received, [b"PING"] * 3)
+        self.assertEqual(self.errors[0], None)
+        self.assertNotEqual(self.errors[1], None)
+        self.assertEqual(self.errors[2:], [None, None])
+
+    def test_udp_send_many_queued(self):
+        self.events = []
+        self.expected = 3
+        client = pyuv.UDP(self.loop)
+        client.bind(("127.0.0.1", TEST_PORT2))
+        # datagrams queued before are not overtaken
+        client.send(("127.0.0.1", TEST_PORT), b"PING0", lambda handle, error: self.events.append("send"))
+        client.send_many([(("127.0.0.1", TEST_PORT), b"PING1"), (("127.0.0.1", TEST_PORT), b"PING2")], lambda handle, errors: self.events.append(errors))
+        client.send_many([], lambda handle, errors: self.events.append(errors))
+        self.assertRaises(TypeError, client.send_many, [b"PING"])
+        self.loop.run()
+        client.close()
+        self.loop.run()
+        self.assertEqual(self.received, [b"PING0", b"PING1", b"PING2"])
+        self.assertEqual(len(self.events), 3)
+        self.assertTrue("send" in self.events and [None, None] in self.events and [] in self.events)
+        self.assertRaises(pyuv.error.HandleClosedError, client.send_to_all, [], b"PING")
+
+
+class UDPTestSegmentation(TestCase):
+
+    def setUp(self):
+        super(UDPTestSegmentation, self).setUp()
+        self.received = []
+        self.server = pyuv.UDP(self.loop)
+        self.server.bind(("127.0.0.1", TEST_PORT))
+        self.client = pyuv.UDP(self.loop)
+        self.client.bind(("127.0.0.1", TEST_PORT2))
+        self.payload = b"".join(b"%099d\n" % i for i in range(50)) + b"END"
+
+    def on_server_recv(self, handle, ip_port, flags, data, error):
+        self.assertEqual(error, None)
+        self.assertEqual(ip_port, ("127.0.0.1", TEST_PORT2))
+        self.received.append(data)
+        if len(self.received) == 51:
+            handle.close()
+
+    def on_send(self, handle, error):
+        self.assertEqual(error, None)
+        handle.close()
+
+    def test_udp_gso_send(self):
+        self.server.start_recv(self.on_server_recv)
+        self.assertRaises(ValueError, self.client.send, ("127.0.0.1", TEST_PORT), b"PING", segment_size=-1)
+        self.assertRaises(TypeError, self.client.send, ("127.0.0.1", TEST_PORT), [b"PING"], segment_size=100)
+        self.client.send(("127.0.0.1", TEST_PORT), self.payload, self.on_send, segment_size=100)
+        self.loop.run()
+        self.assertEqual(len(self.received), 51)
+        self.assertEqual(self.received[-1], b"END")
+        self.assertEqual(b"".join(self.received), self.payload)
+
+    @platform_skip(["win32", "darwin", "freebsd"])
+    def test_udp_gro_recv(self):
+        self.server.start_recv(self.on_server_recv, gro=True)
+        self.client.send(("127.0.0.1", TEST_PORT), self.payload, self.on_send, segment_size=100)
+        self.loop.run()
+        self.assertEqual(b"".join(self.received), self.payload)
+        self.assertTrue(all(len(data) == 100 for data in self.received[:-1]))
+
+    @platform_skip(["win32", "darwin", "freebsd"])
+    def test_udp_gro_recv_batch(self):
+        self.batches = []
+        def on_recv(handle, datagrams, error):
+            self.assertEqual(error, None)
+            self.batches.append(datagrams)
+            if sum(len(batch) for batch in self.batches) == 51:
+                handle.close()
+        self.server.start_recv(on_recv, max_batch=16, gro=True)
+        self.client.send(("127.0.0.1", TEST_PORT), self.payload, self.on_send, segment_size=100)
+        self.loop.run()
+        self.assertTrue(all(len(batch) <= 16 for batch in self.batches))
+        self.assertEqual(b"".join(data for batch in self.batches for addr, data in batch), self.payload)
+
+    @platform_skip(["win32", "darwin", "freebsd"])
+    def test_udp_gro_recv_unbound(self):
+        UDP_GRO = 104
+        handle = pyuv.UDP(self.loop)
+        handle.start_recv(self.on_server_recv, gro=True)
+        self.assertEqual(handle.getsockname()[0], "0.0.0.0")
+        sock = socket.fromfd(handle.fileno(), socket.AF_INET, socket.SOCK_DGRAM)
+        self.assertEqual(sock.getsockopt(socket.IPPROTO_UDP, UDP_GRO), 1)
+        self.assertRaises(pyuv.error.UDPError, handle.start_recv, self.on_server_recv, gro=True)
+        self.assertEqual(sock.getsockopt(socket.IPPROTO_UDP, UDP_GRO), 1)
+        sock.close()
+        handle.close()
+        self.server.close()
+        self.client.close()
+        self.loop.run()
+
+
+class UDPTestAddress(TestCase):
+
+    def test_address(self):
+        addr = pyuv.Address("127.0.0.1", TEST_PORT)
+        self.assertEqual(addr, ("127.0.0.1", TEST_PORT))
+        self.assertEqual(addr, pyuv.Address("127.0.0.1", TEST_PORT))
+        self.assertNotEqual(addr, pyuv.Address("127.0.0.1", TEST_PORT2))
+        self.assertEqual(hash(addr), hash(("127.0.0.1", TEST_PORT)))
+        self.assertEqual((addr.host, addr.port, addr.family), ("127.0.0.1", TEST_PORT, socket.AF_INET))
+        ip, port = addr
+        self.assertEqual((ip, port), ("127.0.0.1", TEST_PORT))
+        addr6 = pyuv.Address("::1", TEST_PORT, 0, 0)
+        self.assertEqual(addr6, ("::1", TEST_PORT, 0, 0))
+        self.assertEqual(len(addr6), 4)
+        self.assertTrue(isinstance(addr, tuple))
+        self.assertEqual(addr[:1] + (TEST_PORT2,), ("127.0.0.1", TEST_PORT2))
+        self.assertEqual(pickle.loads(pickle.dumps(addr)), addr)
+        self.assertEqual(type(pickle.loads(pickle.dumps(addr))), pyuv.Address)
+        self.assertRaises(ValueError, pyuv.Address, "localhost", TEST_PORT)
+        self.assertRaises(OverflowError, pyuv.Address, "127.0.0.1", 65536)
+        self.assertRaises(TypeError, pyuv.Address, "127.0.0.1")
+
+    def test_udp_address_pingpong(self):
+        self.peers = []
+        server = pyuv.UDP(self.loop)
+        server.bind(pyuv.Address("127.0.0.1", TEST_PORT))
+        client = pyuv.UDP(self.loop)
+        client.bind(("127.0.0.1", TEST_PORT2))
+        def on_server_recv(handle, address, flags, data, error):
+            self.assertEqual(error, None)
+            self.assertTrue(isinstance(address, pyuv.Address))
+            self.peers.append(address)
+            if len(self.peers) == 3:
+                handle.send(address, b"PONG")
+        def on_client_recv(handle, address, flags, data, error):
+            self.assertEqual(data, b"PONG")
+            self.assertEqual(address, ("127.0.0.1", TEST_PORT))
+            client.close()
+            server.close()
+        server.start_recv(on_server_recv)
+        client.start_recv(on_client_recv)
+        address = pyuv.Address("127.0.0.1", TEST_PORT)
+        for i in range(3):
+            client.send(address, b"PING")
+        self.loop.run()
+        self.assertEqual(self.peers[0], ("127.0.0.1", TEST_PORT2))
+        # the peer cache hands out the same object for every datagram
+        self.assertTrue(self.peers[0] is self.peers[1] is self.peers[2])
+
+    def test_udp_address_stdlib(self):
+        self.formatted = None
+        server = pyuv.UDP(self.loop)
+        server.bind(("127.0.0.1", TEST_PORT))
+        client = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        client.bind(("127.0.0.1", TEST_PORT2))
+        def on_server_recv(handle, address, flags, data, error):
+            self.assertEqual(error, None)
+            self.formatted = "%s:%d" % address
+            # received addresses are tuples, the socket module takes them as they are
+            sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            sock.sendto(b"PONG", address)
+            sock.close()
+            handle.close()
+        server.start_recv(on_server_recv)
+        client.sendto(b"PING", ("127.0.0.1", TEST_PORT))
+        self.loop.run()
+        client.settimeout(5)
+        self.assertEqual(client.recv(64), b"PONG")
+        client.close()
+        self.assertEqual(self.formatted, "127.0.0.1:%d" % TEST_PORT2)
+
+
+class UDPTestConnect(TestCase):
+
+    @platform_skip(["win32", "darwin", "freebsd"])
+    def test_udp_connect(self):
+        self.peers = []
+        server = pyuv.UDP(self.loop)
+        server.bind(("127.0.0.1", TEST_PORT))
+        client = pyuv.UDP(self.loop)
+        self.assertRaises(pyuv.error.UDPError, client.send, None, b"PING")
+        self.assertRaises(pyuv.error.UDPError, client.getpeername)
+        client.connect(("127.0.0.1", TEST_PORT))
+        self.assertEqual(client.getpeername(), ("127.0.0.1", TEST_PORT))
+        def on_server_recv(handle, address, flags, data, error):
+            self.assertEqual(error, None)
+            self.assertEqual(data, b"PING")
+            handle.send(address, b"PONG")
+        def on_client_recv(handle, address, flags, data, error):
+            self.assertEqual(error, None)
+            self.assertEqual(data, b"PONG")
+            self.peers.append(address)
+            if len(self.peers) == 3:
+                client.close()
+                server.close()
+        def on_send(handle, error):
+            self.assertEqual(error, None)
+        server.start_recv(on_server_recv)
+        client.start_recv(on_client_recv)
+        self.assertEqual(client.try_send(None, b"PING"), 4)
+        client.send(None, b"PING", on_send)
+        client.send(None, [b"PI", b"NG"])
+        self.loop.run()
+        self.assertEqual(self.peers[0], ("127.0.0.1", TEST_PORT))
+        self.assertTrue(self.peers[0] is self.peers[1] is self.peers[2])
+
+
 class UDPEarlyBindTest(TestCase):
 
     def test_early_bind_unspec(self):